@@ -0,0 +1,474 @@
+// Benchmarks of the SearchServer entry points on a synthetic corpus.
+//
+// Build from this directory:
+//     g++ -std=c++17 -O2 -I../search_server search_benchmark.cpp $(ls ../search_server/*.cpp | grep -v main.cpp) -ltbb -pthread -o search_benchmark
+//
+// Usage: search_benchmark [--sizes N1,N2,...] [--words W] [--zipf S] [--document-length L]
+//                         [--query-length Q] [--minus-ratio R] [--statuses A,I,B,R]
+//                         [--queries N] [--seed SEED]
+//
+// For every corpus size N builds a server of N documents and measures adding
+// them, every FindTopDocuments overload, MatchDocument, RequestQueue alone
+// and shared by several threads, and Paginate, then compresses the postings of a copy and measures compressing,
+// the memory the postings take in either form and the searches again. Words of documents and queries follow a Zipf distribution with
+// exponent S over W distinct words, the three most frequent of which are stop
+// words. A query word is a minus word with probability R; statuses are drawn
+// with the weights A,I,B,R. The same seed gives the same corpus and queries.
+//
+// Prints one JSON object: the configuration, a list of results, each with
+// the number of operations, their total time and latency percentiles in
+// nanoseconds, and a list of memory usages in bytes. The checksum sums the
+// sizes of the results, so a change that alters what the server returns shows
+// up next to the timings.
+
+#include "document.h"
+#include "paginator.h"
+#include "request_queue.h"
+#include "search_server.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <execution>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+struct Options {
+    vector<int> sizes = { 1000, 10000, 100000 };
+    int words = 20000;
+    double zipf = 1.0;
+    int document_length = 30;
+    int query_length = 3;
+    double minus_ratio = 0.1;
+    vector<double> statuses = { 85, 5, 5, 5 };
+    int queries = 1000;
+    unsigned seed = 1;
+};
+
+const int STOP_WORD_COUNT = 3;
+const int ADD_BATCH_SIZE = 1000;
+const size_t PAGE_SIZE = 10;
+
+template <typename Value>
+vector<Value> ParseList(const string& text) {
+    vector<Value> values;
+    size_t begin = 0;
+    while (begin <= text.size()) {
+        const size_t end = min(text.find(',', begin), text.size());
+        values.push_back(static_cast<Value>(stod(text.substr(begin, end - begin))));
+        begin = end + 1;
+    }
+    return values;
+}
+
+// Word of rank k is drawn with probability proportional to 1 / (k + 1)^exponent
+class ZipfDistribution {
+public:
+    ZipfDistribution(int word_count, double exponent) {
+        double sum = 0.0;
+        for (int rank = 0; rank < word_count; ++rank) {
+            sum += 1.0 / pow(rank + 1.0, exponent);
+            cumulative_weights_.push_back(sum);
+        }
+    }
+
+    int operator()(mt19937_64& generator) const {
+        const double u = uniform_real_distribution<>(0.0, cumulative_weights_.back())(generator);
+        const auto it = upper_bound(cumulative_weights_.begin(), cumulative_weights_.end(), u);
+        return static_cast<int>(min(it - cumulative_weights_.begin(),
+            static_cast<ptrdiff_t>(cumulative_weights_.size()) - 1));
+    }
+
+private:
+    vector<double> cumulative_weights_;
+};
+
+string GetWord(int rank) {
+    return "w" + to_string(rank);
+}
+
+struct Corpus {
+    vector<string> texts;
+    vector<DocumentInput> documents;
+    vector<string> queries;
+};
+
+Corpus GenerateCorpus(const Options& options, int document_count) {
+    mt19937_64 generator(options.seed);
+    const ZipfDistribution zipf(options.words, options.zipf);
+    discrete_distribution<int> status_distribution(options.statuses.begin(), options.statuses.end());
+    uniform_int_distribution<int> rating_distribution(-10, 10);
+
+    Corpus corpus;
+    corpus.texts.resize(document_count);
+    for (int id = 0; id < document_count; ++id) {
+        string& text = corpus.texts[id];
+        for (int i = 0; i < options.document_length; ++i) {
+            text += GetWord(zipf(generator)) + ' ';
+        }
+        corpus.documents.push_back({ id, text, static_cast<DocumentStatus>(status_distribution(generator)),
+            { rating_distribution(generator), rating_distribution(generator), rating_distribution(generator) } });
+    }
+
+    bernoulli_distribution minus_distribution(options.minus_ratio);
+    for (int i = 0; i < options.queries; ++i) {
+        string query;
+        for (int j = 0; j < options.query_length; ++j) {
+            if (minus_distribution(generator)) {
+                query += '-';
+            }
+            query += GetWord(zipf(generator)) + ' ';
+        }
+        corpus.queries.push_back(query);
+    }
+    return corpus;
+}
+
+string GetStopWords() {
+    string stop_words;
+    for (int rank = 0; rank < STOP_WORD_COUNT; ++rank) {
+        stop_words += GetWord(rank) + ' ';
+    }
+    return stop_words;
+}
+
+using Clock = chrono::steady_clock;
+
+struct Result {
+    string name;
+    int corpus_size;
+    vector<double> latencies;
+    double total_ns = 0.0;
+    long long checksum = 0;
+};
+
+struct MemoryUsage {
+    string name;
+    int corpus_size;
+    size_t bytes;
+};
+
+double Percentile(const vector<double>& sorted_values, double fraction) {
+    if (sorted_values.empty()) {
+        return 0.0;
+    }
+    const size_t index = min(sorted_values.size() - 1, static_cast<size_t>(fraction * sorted_values.size()));
+    return sorted_values[index];
+}
+
+// Times operation(i) for every i below operation_count. A tenth of the
+// operations is run once beforehand, so lazily allocated buffers are warm.
+template <typename Operation>
+Result Measure(string name, int corpus_size, int operation_count, Operation operation) {
+    for (int i = 0; i < operation_count / 10; ++i) {
+        operation(i);
+    }
+    Result result{ move(name), corpus_size, {} };
+    result.latencies.reserve(operation_count);
+    for (int i = 0; i < operation_count; ++i) {
+        const Clock::time_point start = Clock::now();
+        result.checksum += operation(i);
+        const double latency = chrono::duration<double, nano>(Clock::now() - start).count();
+        result.latencies.push_back(latency);
+        result.total_ns += latency;
+    }
+    return result;
+}
+
+void BenchmarkCorpus(const Options& options, int corpus_size, vector<Result>& results,
+    vector<MemoryUsage>& memory_usages) {
+    const Corpus corpus = GenerateCorpus(options, corpus_size);
+    const int query_count = static_cast<int>(corpus.queries.size());
+
+    // Adding is measured once, without a warm-up: the server is built just here
+    SearchServer search_server(GetStopWords());
+    {
+        Result result{ "AddDocument", corpus_size, {} };
+        for (const DocumentInput& document : corpus.documents) {
+            const Clock::time_point start = Clock::now();
+            search_server.AddDocument(document.document_id, document.document, document.status, document.ratings);
+            const double latency = chrono::duration<double, nano>(Clock::now() - start).count();
+            result.latencies.push_back(latency);
+            result.total_ns += latency;
+        }
+        result.checksum = search_server.GetDocumentCount();
+        results.push_back(move(result));
+    }
+    {
+        SearchServer batch_server(GetStopWords());
+        Result result{ "AddDocuments/par/batch=" + to_string(ADD_BATCH_SIZE), corpus_size, {} };
+        for (size_t begin = 0; begin < corpus.documents.size(); begin += ADD_BATCH_SIZE) {
+            const vector<DocumentInput> batch(corpus.documents.begin() + begin,
+                corpus.documents.begin() + min(corpus.documents.size(), begin + ADD_BATCH_SIZE));
+            const Clock::time_point start = Clock::now();
+            batch_server.AddDocuments(execution::par, batch);
+            const double latency = chrono::duration<double, nano>(Clock::now() - start).count();
+            result.latencies.push_back(latency);
+            result.total_ns += latency;
+        }
+        result.checksum = batch_server.GetDocumentCount();
+        results.push_back(move(result));
+    }
+
+    const auto is_even = [](int document_id, DocumentStatus, int) {
+        return document_id % 2 == 0;
+    };
+    const auto find = [&](string name, auto search) {
+        results.push_back(Measure("FindTopDocuments/" + move(name), corpus_size, query_count,
+            [&](int i) {
+                return static_cast<long long>(search(corpus.queries[i]).size());
+            }));
+    };
+    find("seq/default", [&](const string& query) {
+        return search_server.FindTopDocuments(query);
+    });
+    find("seq/status", [&](const string& query) {
+        return search_server.FindTopDocuments(query, DocumentStatus::BANNED);
+    });
+    find("seq/predicate", [&](const string& query) {
+        return search_server.FindTopDocuments(query, is_even);
+    });
+    find("par/default", [&](const string& query) {
+        return search_server.FindTopDocuments(execution::par, query);
+    });
+    find("par/status", [&](const string& query) {
+        return search_server.FindTopDocuments(execution::par, query, DocumentStatus::BANNED);
+    });
+    find("par/predicate", [&](const string& query) {
+        return search_server.FindTopDocuments(execution::par, query, is_even);
+    });
+    ThreadPool thread_pool;
+    find("thread_pool/default", [&](const string& query) {
+        return search_server.FindTopDocuments(thread_pool, query);
+    });
+
+    vector<PreparedQuery> prepared_queries;
+    for (const string& query : corpus.queries) {
+        prepared_queries.push_back(search_server.Prepare(query));
+    }
+    const auto find_prepared = [&](string name, auto search) {
+        results.push_back(Measure("FindTopDocuments/prepared/" + move(name), corpus_size, query_count,
+            [&](int i) {
+                return static_cast<long long>(search(prepared_queries[i]).size());
+            }));
+    };
+    find_prepared("seq/default", [&](const PreparedQuery& query) {
+        return search_server.FindTopDocuments(query);
+    });
+    find_prepared("par/default", [&](const PreparedQuery& query) {
+        return search_server.FindTopDocuments(execution::par, query);
+    });
+
+    // Every query is matched against a document drawn with a fixed seed
+    mt19937_64 generator(options.seed);
+    vector<int> match_document_ids(query_count);
+    for (int& document_id : match_document_ids) {
+        document_id = static_cast<int>(generator() % corpus_size);
+    }
+    const auto match = [&](string name, auto match_document) {
+        results.push_back(Measure("MatchDocument/" + move(name), corpus_size, query_count,
+            [&](int i) {
+                return static_cast<long long>(get<0>(match_document(i, match_document_ids[i])).size());
+            }));
+    };
+    match("seq", [&](int i, int document_id) {
+        return search_server.MatchDocument(corpus.queries[i], document_id);
+    });
+    match("par", [&](int i, int document_id) {
+        return search_server.MatchDocument(execution::par, corpus.queries[i], document_id);
+    });
+    match("prepared", [&](int i, int document_id) {
+        return search_server.MatchDocument(prepared_queries[i], document_id);
+    });
+
+    // The same searches on compressed postings: checksums equal the ones
+    // above, the difference is the time and the memory
+    SearchServer compressed_server = search_server;
+    {
+        Result result{ "CompressPostings", corpus_size, {} };
+        const Clock::time_point start = Clock::now();
+        compressed_server.CompressPostings();
+        result.total_ns = chrono::duration<double, nano>(Clock::now() - start).count();
+        result.latencies.push_back(result.total_ns);
+        result.checksum = compressed_server.GetDocumentCount();
+        results.push_back(move(result));
+    }
+    memory_usages.push_back({ "postings", corpus_size, search_server.GetPostingMemoryUsage() });
+    memory_usages.push_back({ "postings/compressed", corpus_size, compressed_server.GetPostingMemoryUsage() });
+    find("compressed/seq/default", [&](const string& query) {
+        return compressed_server.FindTopDocuments(query);
+    });
+    find("compressed/seq/status", [&](const string& query) {
+        return compressed_server.FindTopDocuments(query, DocumentStatus::BANNED);
+    });
+    find("compressed/par/default", [&](const string& query) {
+        return compressed_server.FindTopDocuments(execution::par, query);
+    });
+    match("compressed/seq", [&](int i, int document_id) {
+        return compressed_server.MatchDocument(corpus.queries[i], document_id);
+    });
+
+    RequestQueue request_queue(search_server);
+    results.push_back(Measure("RequestQueue::AddFindRequest", corpus_size, query_count,
+        [&](int i) {
+            return static_cast<long long>(request_queue.AddFindRequest(corpus.queries[i]).size());
+        }));
+    // A word missing from the dictionary leaves little but the recording
+    results.push_back(Measure("RequestQueue::AddFindRequest/unknown_word", corpus_size, query_count,
+        [&](int) {
+            return static_cast<long long>(request_queue.AddFindRequest("unknown").size());
+        }));
+    // Threads share the queue and contend for its recording lock
+    {
+        RequestQueue shared_queue(search_server);
+        const int thread_count = static_cast<int>(max(2u, thread::hardware_concurrency()));
+        Result result{ "RequestQueue::AddFindRequest/threads=" + to_string(thread_count), corpus_size, {} };
+        vector<Result> thread_results(thread_count);
+        vector<thread> threads;
+        for (int thread_index = 0; thread_index < thread_count; ++thread_index) {
+            threads.emplace_back([&, thread_index] {
+                Result& thread_result = thread_results[thread_index];
+                for (int i = thread_index; i < query_count; i += thread_count) {
+                    const Clock::time_point start = Clock::now();
+                    thread_result.checksum += static_cast<long long>(shared_queue.AddFindRequest(corpus.queries[i]).size());
+                    thread_result.latencies.push_back(chrono::duration<double, nano>(Clock::now() - start).count());
+                }
+            });
+        }
+        for (thread& request_thread : threads) {
+            request_thread.join();
+        }
+        for (const Result& thread_result : thread_results) {
+            result.latencies.insert(result.latencies.end(), thread_result.latencies.begin(), thread_result.latencies.end());
+            result.checksum += thread_result.checksum;
+        }
+        for (double latency : result.latencies) {
+            result.total_ns += latency;
+        }
+        results.push_back(move(result));
+    }
+
+    // Pages of long result lists, as a results page would show them
+    vector<vector<Document>> long_results;
+    for (const string& query : corpus.queries) {
+        long_results.push_back(search_server.FindTopDocuments(query, DocumentStatus::ACTUAL, 100));
+    }
+    results.push_back(Measure("Paginate/page_size=" + to_string(PAGE_SIZE), corpus_size, query_count,
+        [&](int i) {
+            long long page_count = 0;
+            for (const auto& page : Paginate(long_results[i], PAGE_SIZE)) {
+                page_count += static_cast<long long>(page.size());
+            }
+            return page_count;
+        }));
+}
+
+template <typename Value>
+void PrintList(ostream& out, const vector<Value>& values) {
+    out << '[';
+    for (size_t i = 0; i < values.size(); ++i) {
+        out << (i == 0 ? "" : ", ") << values[i];
+    }
+    out << ']';
+}
+
+void PrintJson(ostream& out, const Options& options, vector<Result>& results,
+    const vector<MemoryUsage>& memory_usages) {
+    out << "{\n  \"config\": {\"sizes\": ";
+    PrintList(out, options.sizes);
+    out << ", \"words\": " << options.words << ", \"zipf\": " << options.zipf
+        << ", \"document_length\": " << options.document_length << ", \"query_length\": " << options.query_length
+        << ", \"minus_ratio\": " << options.minus_ratio << ", \"statuses\": ";
+    PrintList(out, options.statuses);
+    out << ", \"queries\": " << options.queries << ", \"seed\": " << options.seed
+        << ", \"stop_words\": " << STOP_WORD_COUNT << "},\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        Result& result = results[i];
+        sort(result.latencies.begin(), result.latencies.end());
+        const size_t operation_count = result.latencies.size();
+        out << (i == 0 ? "\n" : ",\n")
+            << "    {\"name\": \"" << result.name << "\", \"corpus_size\": " << result.corpus_size
+            << ", \"operations\": " << operation_count << ", \"total_ns\": " << llround(result.total_ns)
+            << ", \"mean_ns\": " << llround(operation_count == 0 ? 0.0 : result.total_ns / operation_count)
+            << ", \"p50_ns\": " << llround(Percentile(result.latencies, 0.5))
+            << ", \"p90_ns\": " << llround(Percentile(result.latencies, 0.9))
+            << ", \"p99_ns\": " << llround(Percentile(result.latencies, 0.99))
+            << ", \"max_ns\": " << llround(result.latencies.empty() ? 0.0 : result.latencies.back())
+            << ", \"checksum\": " << result.checksum << '}';
+    }
+    out << "\n  ],\n  \"memory\": [";
+    for (size_t i = 0; i < memory_usages.size(); ++i) {
+        const MemoryUsage& memory_usage = memory_usages[i];
+        out << (i == 0 ? "\n" : ",\n")
+            << "    {\"name\": \"" << memory_usage.name << "\", \"corpus_size\": " << memory_usage.corpus_size
+            << ", \"bytes\": " << memory_usage.bytes << '}';
+    }
+    out << "\n  ]\n}" << endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        for (int i = 1; i + 1 < argc; i += 2) {
+            const string_view option = argv[i];
+            const string value = argv[i + 1];
+            if (option == "--sizes") {
+                options.sizes = ParseList<int>(value);
+            }
+            else if (option == "--words") {
+                options.words = max(STOP_WORD_COUNT + 1, stoi(value));
+            }
+            else if (option == "--zipf") {
+                options.zipf = stod(value);
+            }
+            else if (option == "--document-length") {
+                options.document_length = max(1, stoi(value));
+            }
+            else if (option == "--query-length") {
+                options.query_length = max(1, stoi(value));
+            }
+            else if (option == "--minus-ratio") {
+                options.minus_ratio = clamp(stod(value), 0.0, 1.0);
+            }
+            else if (option == "--statuses") {
+                options.statuses = ParseList<double>(value);
+                options.statuses.resize(4, 0.0);
+            }
+            else if (option == "--queries") {
+                options.queries = max(1, stoi(value));
+            }
+            else if (option == "--seed") {
+                options.seed = static_cast<unsigned>(stoul(value));
+            }
+            else {
+                cerr << "Unknown option " << option << endl;
+                return 1;
+            }
+        }
+
+        vector<Result> results;
+        vector<MemoryUsage> memory_usages;
+        for (int corpus_size : options.sizes) {
+            if (corpus_size > 0) {
+                BenchmarkCorpus(options, corpus_size, results, memory_usages);
+            }
+        }
+        PrintJson(cout, options, results, memory_usages);
+    }
+    catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,37 @@
+#include "async_search.h"
+
+#include "string_processing.h"
+
+using namespace std;
+
+future<vector<Document>> FindTopDocumentsAsync(ThreadPool& thread_pool, const SearchServer& search_server,
+    string raw_query, DocumentStatus status, size_t max_result_count, CancellationToken cancellation_token,
+    int large_query_posting_count) {
+    return FindTopDocumentsAsync(thread_pool, search_server, move(raw_query), DocumentStatusFilter{ status },
+        max_result_count, move(cancellation_token), large_query_posting_count);
+}
+
+future<vector<Document>> FindTopDocumentsAsync(ThreadPool& thread_pool, const SearchServer& search_server,
+    string raw_query) {
+    return FindTopDocumentsAsync(thread_pool, search_server, move(raw_query), DocumentStatus::ACTUAL);
+}
+
+future<tuple<vector<string_view>, DocumentStatus>> MatchDocumentAsync(ThreadPool& thread_pool,
+    const SearchServer& search_server, string raw_query, int document_id, CancellationToken cancellation_token) {
+    return thread_pool.Submit(
+        [&search_server, raw_query = move(raw_query), document_id, cancellation_token] {
+            cancellation_token.ThrowIfCancelled();
+            return search_server.MatchDocument(raw_query, document_id);
+        });
+}
+
+int CountQueryPostings(const SearchServer& search_server, string_view raw_query) {
+    int posting_count = 0;
+    for (string_view word : SplitIntoWords(raw_query)) {
+        if (!word.empty() && word[0] == '-') {
+            word.remove_prefix(1);
+        }
+        posting_count += search_server.GetDocumentFreq(word);
+    }
+    return posting_count;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "cancellation.h"
+#include "document.h"
+#include "search_server.h"
+#include "thread_pool.h"
+
+#include <future>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Searches run as tasks of a ThreadPool. The server must outlive the futures
+// and must not change until they are ready; the query is copied.
+//
+// A query whose words have at least large_query_posting_count postings in
+// total is scanned with sub-tasks on the same pool. Smaller ones run on a
+// single worker.
+//
+// Once the token is cancelled the future gets OperationCancelled. The scan
+// checks the token every posting block, sub-tasks every block of their range.
+inline constexpr int DEFAULT_LARGE_QUERY_POSTING_COUNT = 100000;
+
+template <typename DocumentPredicate>
+std::future<std::vector<Document>> FindTopDocumentsAsync(ThreadPool& thread_pool, const SearchServer& search_server,
+    std::string raw_query, DocumentPredicate document_predicate, size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT,
+    CancellationToken cancellation_token = {}, int large_query_posting_count = DEFAULT_LARGE_QUERY_POSTING_COUNT);
+
+std::future<std::vector<Document>> FindTopDocumentsAsync(ThreadPool& thread_pool, const SearchServer& search_server,
+    std::string raw_query, DocumentStatus status, size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT,
+    CancellationToken cancellation_token = {}, int large_query_posting_count = DEFAULT_LARGE_QUERY_POSTING_COUNT);
+
+std::future<std::vector<Document>> FindTopDocumentsAsync(ThreadPool& thread_pool, const SearchServer& search_server,
+    std::string raw_query);
+
+std::future<std::tuple<std::vector<std::string_view>, DocumentStatus>> MatchDocumentAsync(ThreadPool& thread_pool,
+    const SearchServer& search_server, std::string raw_query, int document_id, CancellationToken cancellation_token = {});
+
+// Postings of all words of the query, minus words included
+int CountQueryPostings(const SearchServer& search_server, std::string_view raw_query);
+
+template <typename DocumentPredicate>
+std::future<std::vector<Document>> FindTopDocumentsAsync(ThreadPool& thread_pool, const SearchServer& search_server,
+    std::string raw_query, DocumentPredicate document_predicate, size_t max_result_count,
+    CancellationToken cancellation_token, int large_query_posting_count) {
+    return thread_pool.Submit(
+        [&thread_pool, &search_server, raw_query = std::move(raw_query), document_predicate, max_result_count,
+        cancellation_token, large_query_posting_count] {
+            cancellation_token.ThrowIfCancelled();
+            // The predicate is passed on as is, so status filters still read one partition
+            if (CountQueryPostings(search_server, raw_query) >= large_query_posting_count) {
+                return search_server.FindTopDocuments(thread_pool, raw_query, document_predicate, max_result_count,
+                    cancellation_token);
+            }
+            return search_server.FindTopDocuments(std::execution::seq, raw_query, document_predicate, max_result_count,
+                cancellation_token);
+        });
+}
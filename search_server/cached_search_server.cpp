@@ -0,0 +1,86 @@
+#include "cached_search_server.h"
+
+using namespace std;
+
+CachedSearchServer::CachedSearchServer(const SearchServer& search_server, size_t capacity)
+    : search_server_(search_server), capacity_(capacity), generation_(search_server.GetGeneration()) {
+}
+
+vector<Document> CachedSearchServer::FindTopDocuments(string_view raw_query, DocumentStatus status,
+    size_t max_result_count) const {
+    // Normalizing throws for a bad query, so errors are never cached
+    string key = MakeKey(raw_query, status, max_result_count);
+    uint64_t search_generation;
+    {
+        lock_guard guard(mutex_);
+        DropIfOutdated();
+        search_generation = generation_;
+        const auto it = entry_by_key_.find(key);
+        if (it != entry_by_key_.end()) {
+            ++hit_count_;
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return it->second->second;
+        }
+        ++miss_count_;
+    }
+
+    vector<Document> documents = search_server_.FindTopDocuments(raw_query, status, max_result_count);
+    if (capacity_ == 0) {
+        return documents;
+    }
+
+    lock_guard guard(mutex_);
+    DropIfOutdated();
+    // A write during the search makes the result stale. Another thread may
+    // also have cached the same query meanwhile.
+    if (generation_ == search_generation && entry_by_key_.count(key) == 0) {
+        if (entries_.size() == capacity_) {
+            entry_by_key_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+        entries_.emplace_front(move(key), documents);
+        entry_by_key_.emplace(entries_.front().first, entries_.begin());
+    }
+    return documents;
+}
+
+vector<Document> CachedSearchServer::FindTopDocuments(string_view raw_query) const {
+    return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
+}
+
+uint64_t CachedSearchServer::GetHitCount() const {
+    lock_guard guard(mutex_);
+    return hit_count_;
+}
+
+uint64_t CachedSearchServer::GetMissCount() const {
+    lock_guard guard(mutex_);
+    return miss_count_;
+}
+
+double CachedSearchServer::GetHitRate() const {
+    lock_guard guard(mutex_);
+    const uint64_t request_count = hit_count_ + miss_count_;
+    return request_count == 0 ? 0.0 : static_cast<double>(hit_count_) / request_count;
+}
+
+size_t CachedSearchServer::GetCachedQueryCount() const {
+    lock_guard guard(mutex_);
+    return entries_.size();
+}
+
+string CachedSearchServer::MakeKey(string_view raw_query, DocumentStatus status, size_t max_result_count) const {
+    string key = search_server_.NormalizeQuery(raw_query);
+    key.append("| ").append(to_string(static_cast<int>(status)))
+        .append(" ").append(to_string(max_result_count));
+    return key;
+}
+
+void CachedSearchServer::DropIfOutdated() const {
+    const uint64_t generation = search_server_.GetGeneration();
+    if (generation != generation_) {
+        entry_by_key_.clear();
+        entries_.clear();
+        generation_ = generation;
+    }
+}
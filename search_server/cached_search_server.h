@@ -0,0 +1,64 @@
+#pragma once
+
+#include "document.h"
+#include "search_server.h"
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Least recently used cache of search results in front of a SearchServer.
+// Results are keyed on the normalized query, so word order, repeated words
+// and stop words do not matter, plus the status and the result count.
+//
+// Every write changes the server's generation. The cache remembers the
+// generation its results were computed at and drops all of them as soon as it
+// sees another one, so a cached result is always the one a search would give.
+// A result is stored only if the generation did not change during its search.
+//
+// Searches with an arbitrary predicate cannot be compared and are not cached.
+// Several threads may search at once; the search itself runs unlocked.
+class CachedSearchServer {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    explicit CachedSearchServer(const SearchServer& search_server, size_t capacity = DEFAULT_CAPACITY);
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
+
+    uint64_t GetHitCount() const;
+
+    uint64_t GetMissCount() const;
+
+    // Share of searches answered from the cache, 0 before the first search
+    double GetHitRate() const;
+
+    size_t GetCachedQueryCount() const;
+
+private:
+    using Entry = std::pair<std::string, std::vector<Document>>;
+
+    const SearchServer& search_server_;
+    const size_t capacity_;
+
+    // Most recently used first. Keys of the map point into the list's keys.
+    mutable std::mutex mutex_;
+    mutable std::list<Entry> entries_;
+    mutable std::unordered_map<std::string_view, std::list<Entry>::iterator> entry_by_key_;
+    mutable uint64_t generation_ = 0;
+    mutable uint64_t hit_count_ = 0;
+    mutable uint64_t miss_count_ = 0;
+
+    std::string MakeKey(std::string_view raw_query, DocumentStatus status, size_t max_result_count) const;
+
+    // Expects mutex_ to be held
+    void DropIfOutdated() const;
+};
@@ -0,0 +1,29 @@
+#include "cancellation.h"
+
+using namespace std;
+
+CancellationToken::CancellationToken(shared_ptr<const atomic<bool>> is_cancelled)
+    : is_cancelled_(move(is_cancelled)) {
+}
+
+bool CancellationToken::IsCancelled() const {
+    return is_cancelled_ && is_cancelled_->load(memory_order_relaxed);
+}
+
+void CancellationToken::ThrowIfCancelled() const {
+    if (IsCancelled()) {
+        throw OperationCancelled("Operation cancelled");
+    }
+}
+
+CancellationSource::CancellationSource()
+    : is_cancelled_(make_shared<atomic<bool>>(false)) {
+}
+
+CancellationToken CancellationSource::GetToken() const {
+    return CancellationToken(is_cancelled_);
+}
+
+void CancellationSource::Cancel() {
+    is_cancelled_->store(true, memory_order_relaxed);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+class OperationCancelled : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Read side of a cancellation flag. Long operations poll it and stop early;
+// a default-constructed token is never cancelled.
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    bool IsCancelled() const;
+
+    // Throws OperationCancelled once the token is cancelled
+    void ThrowIfCancelled() const;
+
+private:
+    friend class CancellationSource;
+
+    std::shared_ptr<const std::atomic<bool>> is_cancelled_;
+
+    explicit CancellationToken(std::shared_ptr<const std::atomic<bool>> is_cancelled);
+};
+
+// Owner of a cancellation flag, handing out tokens that observe it
+class CancellationSource {
+public:
+    CancellationSource();
+
+    CancellationToken GetToken() const;
+
+    void Cancel();
+
+private:
+    std::shared_ptr<std::atomic<bool>> is_cancelled_;
+};
@@ -0,0 +1,205 @@
+#include "compressed_posting_list.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+// A term frequency is packed as length << COUNT_BITS | count, count 0 escapes
+// a value written as it is
+constexpr uint32_t COUNT_BITS = 2;
+constexpr uint32_t MAX_PACKED_COUNT = (1u << COUNT_BITS) - 1;
+constexpr double MAX_PACKED_LENGTH = static_cast<double>(UINT32_MAX >> COUNT_BITS);
+
+// 1 / length of the usual documents, so decoding rarely divides
+constexpr size_t INVERSE_LENGTH_COUNT = 256;
+
+const array<double, INVERSE_LENGTH_COUNT> INVERSE_LENGTHS = [] {
+    array<double, INVERSE_LENGTH_COUNT> inverse_lengths{};
+    for (size_t length = 1; length < INVERSE_LENGTH_COUNT; ++length) {
+        inverse_lengths[length] = 1.0 / length;
+    }
+    return inverse_lengths;
+}();
+
+void WriteVarint(vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint32_t ReadVarint(const vector<uint8_t>& in, size_t& offset) {
+    uint32_t value = 0;
+    int shift = 0;
+    while (in[offset] & 0x80) {
+        value |= static_cast<uint32_t>(in[offset++] & 0x7F) << shift;
+        shift += 7;
+    }
+    value |= static_cast<uint32_t>(in[offset++]) << shift;
+    return value;
+}
+
+// Same sum as SearchServer makes for a word met count times in a document
+double SumInverseLengths(uint32_t count, uint32_t length) {
+    const double inverse_length = length < INVERSE_LENGTH_COUNT ? INVERSE_LENGTHS[length] : 1.0 / length;
+    double term_freq = 0.0;
+    for (uint32_t i = 0; i < count; ++i) {
+        term_freq += inverse_length;
+    }
+    return term_freq;
+}
+
+void WriteTermFreq(vector<uint8_t>& out, double term_freq) {
+    for (uint32_t count = 1; count <= MAX_PACKED_COUNT; ++count) {
+        const double length = round(count / term_freq);
+        if (length >= 1.0 && length <= MAX_PACKED_LENGTH
+            && SumInverseLengths(count, static_cast<uint32_t>(length)) == term_freq) {
+            WriteVarint(out, static_cast<uint32_t>(length) << COUNT_BITS | count);
+            return;
+        }
+    }
+    WriteVarint(out, 0);
+    uint8_t bytes[sizeof(double)];
+    memcpy(bytes, &term_freq, sizeof(double));
+    out.insert(out.end(), begin(bytes), end(bytes));
+}
+
+double ReadTermFreq(const vector<uint8_t>& in, size_t& offset) {
+    const uint32_t value = ReadVarint(in, offset);
+    const uint32_t count = value & MAX_PACKED_COUNT;
+    if (count == 0) {
+        double term_freq;
+        memcpy(&term_freq, &in[offset], sizeof(double));
+        offset += sizeof(double);
+        return term_freq;
+    }
+    return SumInverseLengths(count, value >> COUNT_BITS);
+}
+
+}  // namespace
+
+CompressedPostingList::CompressedPostingList(const vector<int>& documents, const vector<double>& term_freqs)
+    : size_(documents.size()) {
+
+    int previous_id = 0;
+    for (size_t block_begin = 0; block_begin < size_; block_begin += BLOCK_SIZE) {
+        const size_t block_end = min(size_, block_begin + BLOCK_SIZE);
+        if (block_begin > 0) {
+            block_ends_.push_back({ previous_id, static_cast<uint32_t>(data_.size()) });
+        }
+        const double block_max_term_freq = *max_element(term_freqs.begin() + block_begin, term_freqs.begin() + block_end);
+        max_term_freq_ = max(max_term_freq_, block_max_term_freq);
+        WriteTermFreq(data_, block_max_term_freq);
+
+        for (size_t i = block_begin; i < block_end; ++i) {
+            const int document_id = documents[i];
+            WriteVarint(data_, static_cast<uint32_t>(document_id - previous_id));
+            WriteTermFreq(data_, term_freqs[i]);
+            previous_id = document_id;
+        }
+    }
+    last_document_id_ = previous_id;
+    data_.shrink_to_fit();
+    block_ends_.shrink_to_fit();
+}
+
+size_t CompressedPostingList::size() const {
+    return size_;
+}
+
+bool CompressedPostingList::empty() const {
+    return size_ == 0;
+}
+
+bool CompressedPostingList::Contains(int document_id) const {
+    Cursor cursor = begin();
+    cursor.SkipTo(document_id);
+    return !cursor.AtEnd() && cursor.GetDocument() == document_id;
+}
+
+CompressedPostingList::Cursor CompressedPostingList::begin() const {
+    return Cursor(*this);
+}
+
+double CompressedPostingList::GetMaxTermFreq() const {
+    return max_term_freq_;
+}
+
+vector<int> CompressedPostingList::GetDocuments() const {
+    vector<int> documents;
+    documents.reserve(size_);
+    for (Cursor cursor = begin(); !cursor.AtEnd(); cursor.Next()) {
+        documents.push_back(cursor.GetDocument());
+    }
+    return documents;
+}
+
+size_t CompressedPostingList::GetMemoryUsage() const {
+    return block_ends_.capacity() * sizeof(BlockEnd) + data_.capacity() * sizeof(uint8_t);
+}
+
+size_t CompressedPostingList::FindBlock(int document_id, size_t first_block) const {
+    // Every block but the last one ends in block_ends_
+    const size_t block_count = block_ends_.size() + 1;
+    if (first_block >= block_count) {
+        return block_count;
+    }
+    const auto it = lower_bound(block_ends_.begin() + first_block, block_ends_.end(), document_id,
+        [](const BlockEnd& block_end, int id) {
+            return block_end.last_document_id < id;
+        });
+    if (it != block_ends_.end()) {
+        return it - block_ends_.begin();
+    }
+    return last_document_id_ < document_id ? block_count : block_count - 1;
+}
+
+int CompressedPostingList::GetBlockLastDocument(size_t block_index) const {
+    return block_index < block_ends_.size() ? block_ends_[block_index].last_document_id : last_document_id_;
+}
+
+CompressedPostingList::Cursor::Cursor(const CompressedPostingList& postings)
+    : postings_(&postings) {
+    if (!AtEnd()) {
+        DecodePosting();
+    }
+}
+
+void CompressedPostingList::Cursor::SkipTo(int document_id) {
+    if (AtEnd() || document_id_ >= document_id) {
+        return;
+    }
+    const size_t block_index = position_ / BLOCK_SIZE;
+    if (postings_->GetBlockLastDocument(block_index) < document_id) {
+        LoadBlock(postings_->FindBlock(document_id, block_index + 1));
+    }
+    while (!AtEnd() && document_id_ < document_id) {
+        Next();
+    }
+}
+
+void CompressedPostingList::Cursor::DecodePosting() {
+    if (position_ % BLOCK_SIZE == 0) {
+        block_max_term_freq_ = ReadTermFreq(postings_->data_, data_offset_);
+    }
+    document_id_ += static_cast<int>(ReadVarint(postings_->data_, data_offset_));
+    term_freq_ = ReadTermFreq(postings_->data_, data_offset_);
+}
+
+void CompressedPostingList::Cursor::LoadBlock(size_t block_index) {
+    position_ = block_index * BLOCK_SIZE;
+    if (AtEnd()) {
+        return;
+    }
+    // Only called for blocks after the first: ids are gaps from the end of the block before
+    const BlockEnd& previous_block_end = postings_->block_ends_[block_index - 1];
+    data_offset_ = previous_block_end.next_data_offset;
+    document_id_ = previous_block_end.last_document_id;
+    DecodePosting();
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Read-only, compact form of InvertedIndex::PostingList, which the index
+// switches to when compressed.
+//
+// Postings are cut into blocks of BLOCK_SIZE. Each posting is written as the
+// varint gap to the previous document id and its term frequency. A block
+// starts with its largest term frequency, which bounds the scores of the
+// block. The last id of every block but the last one is kept apart with the
+// offset of the next block, which lets lookups skip to the one block that may
+// hold a document; a list of one block needs none of them.
+//
+// A term frequency is the word count of a document over its length, summed
+// one 1/length at a time, so it is written as one varint of the two numbers
+// and rebuilt by the same sum, bit for bit. A value not of this form is
+// written as it is, after an escape.
+class CompressedPostingList {
+public:
+    static constexpr size_t BLOCK_SIZE = 128;
+
+    // Forward cursor over the postings in document id order, with the
+    // interface of InvertedIndex::PostingList::Cursor
+    class Cursor {
+    public:
+        explicit Cursor(const CompressedPostingList& postings);
+
+        bool AtEnd() const {
+            return position_ >= postings_->size_;
+        }
+
+        int GetDocument() const {
+            return document_id_;
+        }
+
+        double GetTermFreq() const {
+            return term_freq_;
+        }
+
+        // Largest term frequency of the block the cursor is in
+        double GetBlockMaxTermFreq() const {
+            return block_max_term_freq_;
+        }
+
+        void Next() {
+            if (++position_ < postings_->size_) {
+                DecodePosting();
+            }
+        }
+
+        // Moves to the first posting with id not less than document_id.
+        // Blocks that end before document_id are skipped without decoding.
+        void SkipTo(int document_id);
+
+    private:
+        const CompressedPostingList* postings_;
+        size_t position_ = 0;
+        size_t data_offset_ = 0;
+        int document_id_ = 0;
+        double term_freq_ = 0.0;
+        double block_max_term_freq_ = 0.0;
+
+        // Decodes the posting at position_, and the block header before it
+        // if it starts a block
+        void DecodePosting();
+
+        void LoadBlock(size_t block_index);
+    };
+
+    CompressedPostingList() = default;
+
+    // Postings as two parallel arrays sorted by document
+    CompressedPostingList(const std::vector<int>& documents, const std::vector<double>& term_freqs);
+
+    size_t size() const;
+
+    bool empty() const;
+
+    bool Contains(int document_id) const;
+
+    Cursor begin() const;
+
+    double GetMaxTermFreq() const;
+
+    std::vector<int> GetDocuments() const;
+
+    // Bytes held by the compressed representation
+    size_t GetMemoryUsage() const;
+
+private:
+    // Boundary between a block and the next one
+    struct BlockEnd {
+        int last_document_id;
+        uint32_t next_data_offset;
+    };
+
+    size_t size_ = 0;
+    double max_term_freq_ = 0.0;
+    int last_document_id_ = 0;
+    std::vector<BlockEnd> block_ends_;
+    std::vector<uint8_t> data_;
+
+    // First block from first_block on that may hold document_id, the block
+    // count if none
+    size_t FindBlock(int document_id, size_t first_block) const;
+
+    int GetBlockLastDocument(size_t block_index) const;
+};
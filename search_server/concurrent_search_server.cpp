@@ -0,0 +1,84 @@
+#include "concurrent_search_server.h"
+
+#include <execution>
+#include <thread>
+
+using namespace std;
+
+ConcurrentSearchServer::ConcurrentSearchServer(SearchServer search_server)
+    : replicas_{ search_server, move(search_server) } {
+}
+
+ConcurrentSearchServer::ReadGuard::ReadGuard(const ConcurrentSearchServer& owner)
+    : owner_(owner)
+    , reader_count_(owner.read_indicators_[owner.version_index_.load()][GetReaderSlot()]) {
+    reader_count_.value.fetch_add(1);
+    search_server_ = &owner_.replicas_[owner_.published_index_.load()];
+}
+
+ConcurrentSearchServer::ReadGuard::~ReadGuard() {
+    reader_count_.value.fetch_sub(1);
+}
+
+const SearchServer& ConcurrentSearchServer::ReadGuard::Get() const {
+    return *search_server_;
+}
+
+shared_ptr<const SearchServer> ConcurrentSearchServer::GetSnapshot() const {
+    // Aliases the guard, which leaves when the last copy is released
+    const auto guard = make_shared<const ReadGuard>(*this);
+    return shared_ptr<const SearchServer>(guard, &guard->Get());
+}
+
+tuple<vector<string>, DocumentStatus> ConcurrentSearchServer::MatchDocument(string_view raw_query, int document_id) const {
+    const ReadGuard guard(*this);
+    const auto [matched_words, status] = guard.Get().MatchDocument(raw_query, document_id);
+    return { vector<string>(matched_words.begin(), matched_words.end()), status };
+}
+
+int ConcurrentSearchServer::GetDocumentCount() const {
+    const ReadGuard guard(*this);
+    return guard.Get().GetDocumentCount();
+}
+
+void ConcurrentSearchServer::AddDocument(int document_id, string_view document, DocumentStatus status,
+    const vector<int>& ratings) {
+    Update([&](SearchServer& search_server) {
+        search_server.AddDocument(document_id, document, status, ratings);
+    });
+}
+
+void ConcurrentSearchServer::AddDocuments(const vector<DocumentInput>& documents) {
+    Update([&documents](SearchServer& search_server) {
+        search_server.AddDocuments(execution::par, documents);
+    });
+}
+
+void ConcurrentSearchServer::RemoveDocument(int document_id) {
+    Update([document_id](SearchServer& search_server) {
+        search_server.RemoveDocument(document_id);
+    });
+}
+
+size_t ConcurrentSearchServer::GetReaderSlot() {
+    static atomic<size_t> next_slot = 0;
+    thread_local const size_t slot = next_slot.fetch_add(1, memory_order_relaxed) % READER_SLOT_COUNT;
+    return slot;
+}
+
+void ConcurrentSearchServer::Publish(int replica_index) {
+    published_index_.store(replica_index);
+    // Readers of the next version are the ones left from the write before
+    const int version_index = version_index_.load();
+    WaitForReaders(1 - version_index);
+    version_index_.store(1 - version_index);
+    WaitForReaders(version_index);
+}
+
+void ConcurrentSearchServer::WaitForReaders(int version_index) const {
+    for (const ReaderCount& reader_count : read_indicators_[version_index]) {
+        while (reader_count.value.load() != 0) {
+            this_thread::yield();
+        }
+    }
+}
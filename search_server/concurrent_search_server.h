@@ -0,0 +1,136 @@
+#pragma once
+
+#include "document.h"
+#include "search_server.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// SearchServer shared by readers and writers without readers ever waiting,
+// after the left-right scheme. There are two replicas of the server: readers
+// use the published one, a writer changes the other, publishes it and, once
+// the readers of the old one are gone, makes the same change to that one
+// too. A write costs the change twice instead of a copy of the server.
+//
+// Readers announce themselves in per-version counters, spread over cache
+// lines, and never retry, so a read is wait-free. Writers wait for the
+// readers of the replica they are about to change, so a reader must not hold
+// a snapshot while writing from the same thread.
+class ConcurrentSearchServer {
+public:
+    explicit ConcurrentSearchServer(SearchServer search_server);
+
+    // Replica published at the time of the call. It does not change while
+    // held, but holds writers back, so it should be released soon, and
+    // before the ConcurrentSearchServer is destroyed.
+    std::shared_ptr<const SearchServer> GetSnapshot() const;
+
+    template <typename... Args>
+    std::vector<Document> FindTopDocuments(Args&&... args) const;
+
+    // Words are copied out: the replica they were found in may change as
+    // soon as the call returns
+    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(std::string_view raw_query, int document_id) const;
+
+    int GetDocumentCount() const;
+
+    // Writes are serialized among themselves. A write that throws publishes
+    // nothing, unlike the same call on SearchServer.
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+
+    void AddDocuments(const std::vector<DocumentInput>& documents);
+
+    void RemoveDocument(int document_id);
+
+    // Applies updater(SearchServer&) to each replica in turn and publishes
+    // all its changes at once. The updater must make the same changes both
+    // times. If it throws on the first replica, that one is copied back from
+    // the published one and the exception is rethrown.
+    template <typename Updater>
+    void Update(Updater updater);
+
+private:
+    static constexpr size_t READER_SLOT_COUNT = 16;
+
+    // Every slot on its own cache line, so readers of different threads
+    // rarely write the same one
+    struct alignas(64) ReaderCount {
+        std::atomic<int64_t> value = 0;
+    };
+
+    using ReadIndicator = std::array<ReaderCount, READER_SLOT_COUNT>;
+
+    // Keeps the published replica from changing while alive
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const ConcurrentSearchServer& owner);
+
+        ReadGuard(const ReadGuard&) = delete;
+
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        ~ReadGuard();
+
+        const SearchServer& Get() const;
+
+    private:
+        const ConcurrentSearchServer& owner_;
+        ReaderCount& reader_count_;
+        const SearchServer* search_server_;
+    };
+
+    std::mutex write_mutex_;
+    std::array<SearchServer, 2> replicas_;
+    std::atomic<int> published_index_ = 0;
+    // Readers arrive at the indicator of the current version. A writer
+    // switches versions and waits for both indicators in turn, so readers
+    // arriving meanwhile never delay it indefinitely.
+    std::atomic<int> version_index_ = 0;
+    mutable std::array<ReadIndicator, 2> read_indicators_;
+
+    // Slot of the calling thread in every read indicator
+    static size_t GetReaderSlot();
+
+    // Makes the replica the one readers use and returns once no reader is
+    // left on the other one
+    void Publish(int replica_index);
+
+    void WaitForReaders(int version_index) const;
+};
+
+template <typename... Args>
+std::vector<Document> ConcurrentSearchServer::FindTopDocuments(Args&&... args) const {
+    const ReadGuard guard(*this);
+    return guard.Get().FindTopDocuments(std::forward<Args>(args)...);
+}
+
+template <typename Updater>
+void ConcurrentSearchServer::Update(Updater updater) {
+    std::lock_guard guard(write_mutex_);
+    const int published_index = published_index_.load();
+    const int standby_index = 1 - published_index;
+    try {
+        updater(replicas_[standby_index]);
+    }
+    catch (...) {
+        // Readers only read the published replica, so it can be copied now
+        replicas_[standby_index] = replicas_[published_index];
+        throw;
+    }
+    Publish(standby_index);
+    try {
+        updater(replicas_[published_index]);
+    }
+    catch (...) {
+        // The change is out already, so the replica catches up by a copy
+        replicas_[published_index] = replicas_[standby_index];
+    }
+}
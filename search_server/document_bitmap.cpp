@@ -0,0 +1,113 @@
+#include "document_bitmap.h"
+
+#include <algorithm>
+#include <bitset>
+#include <iterator>
+
+using namespace std;
+
+bool DocumentBitmap::Chunk::IsBitset() const {
+    return !bits.empty();
+}
+
+bool DocumentBitmap::Chunk::Contains(uint16_t value) const {
+    if (IsBitset()) {
+        return (bits[value / 64] >> (value % 64)) & 1;
+    }
+    return binary_search(values.begin(), values.end(), value);
+}
+
+void DocumentBitmap::Chunk::ConvertToBitset() {
+    bits.assign(BITSET_WORDS, 0);
+    for (uint16_t value : values) {
+        bits[value / 64] |= uint64_t{ 1 } << (value % 64);
+    }
+    values.clear();
+    values.shrink_to_fit();
+}
+
+void DocumentBitmap::Chunk::UnionWith(const Chunk& other) {
+    if (!IsBitset() && !other.IsBitset() && size + other.size <= ARRAY_LIMIT) {
+        vector<uint16_t> merged;
+        merged.reserve(size + other.size);
+        set_union(values.begin(), values.end(), other.values.begin(), other.values.end(), back_inserter(merged));
+        values = move(merged);
+        size = values.size();
+        return;
+    }
+
+    if (!IsBitset()) {
+        ConvertToBitset();
+    }
+    if (other.IsBitset()) {
+        for (size_t i = 0; i < BITSET_WORDS; ++i) {
+            bits[i] |= other.bits[i];
+        }
+    }
+    else {
+        for (uint16_t value : other.values) {
+            bits[value / 64] |= uint64_t{ 1 } << (value % 64);
+        }
+    }
+    size = 0;
+    for (uint64_t word : bits) {
+        size += bitset<64>(word).count();
+    }
+}
+
+DocumentBitmap::DocumentBitmap(const vector<int>& documents) {
+    for (size_t begin = 0; begin < documents.size();) {
+        const uint16_t key = static_cast<uint16_t>(documents[begin] >> 16);
+        size_t end = begin;
+        while (end < documents.size() && (documents[end] >> 16) == key) {
+            ++end;
+        }
+
+        Chunk& chunk = chunks_.emplace_back();
+        chunk.key = key;
+        chunk.size = end - begin;
+        if (chunk.size > ARRAY_LIMIT) {
+            chunk.bits.assign(BITSET_WORDS, 0);
+            for (size_t i = begin; i < end; ++i) {
+                const uint16_t value = static_cast<uint16_t>(documents[i] & 0xFFFF);
+                chunk.bits[value / 64] |= uint64_t{ 1 } << (value % 64);
+            }
+        }
+        else {
+            chunk.values.reserve(chunk.size);
+            for (size_t i = begin; i < end; ++i) {
+                chunk.values.push_back(static_cast<uint16_t>(documents[i] & 0xFFFF));
+            }
+        }
+        begin = end;
+    }
+}
+
+bool DocumentBitmap::Contains(int document) const {
+    const uint16_t key = static_cast<uint16_t>(document >> 16);
+    const auto it = lower_bound(chunks_.begin(), chunks_.end(), key,
+        [](const Chunk& chunk, uint16_t key) {
+            return chunk.key < key;
+        });
+    return it != chunks_.end() && it->key == key && it->Contains(static_cast<uint16_t>(document & 0xFFFF));
+}
+
+void DocumentBitmap::UnionWith(const DocumentBitmap& other) {
+    vector<Chunk> merged;
+    merged.reserve(chunks_.size() + other.chunks_.size());
+    auto it = chunks_.begin();
+    auto other_it = other.chunks_.begin();
+    while (it != chunks_.end() || other_it != other.chunks_.end()) {
+        if (other_it == other.chunks_.end() || (it != chunks_.end() && it->key < other_it->key)) {
+            merged.push_back(move(*it++));
+        }
+        else if (it == chunks_.end() || other_it->key < it->key) {
+            merged.push_back(*other_it++);
+        }
+        else {
+            it->UnionWith(*other_it++);
+            merged.push_back(move(*it++));
+        }
+    }
+    chunks_ = move(merged);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compressed set of documents in the spirit of roaring bitmaps.
+//
+// Documents are split by their upper 16 bits into chunks of 65536. A sparse
+// chunk stores its lower 16 bits as a sorted array; once it holds more than
+// ARRAY_LIMIT documents it switches to a plain 8 KiB bitset, which is never
+// larger than the array would be. Lookups find the chunk by binary search
+// over the few chunk keys and then cost a bit test or a short binary search.
+class DocumentBitmap {
+public:
+    static constexpr size_t ARRAY_LIMIT = 4096;
+
+    DocumentBitmap() = default;
+
+    // documents must be non-negative and sorted ascending
+    explicit DocumentBitmap(const std::vector<int>& documents);
+
+    bool Contains(int document) const;
+
+    void UnionWith(const DocumentBitmap& other);
+
+private:
+    static constexpr size_t BITSET_WORDS = (1 << 16) / 64;
+
+    struct Chunk {
+        uint16_t key = 0;
+        size_t size = 0;
+        // Exactly one of the two is in use: bits when the chunk is dense
+        std::vector<uint16_t> values;
+        std::vector<uint64_t> bits;
+
+        bool IsBitset() const;
+
+        bool Contains(uint16_t value) const;
+
+        void ConvertToBitset();
+
+        void UnionWith(const Chunk& other);
+    };
+
+    std::vector<Chunk> chunks_;
+};
@@ -0,0 +1,29 @@
+#include "instrumented_search_server.h"
+
+using namespace std;
+
+InstrumentedSearchServer::InstrumentedSearchServer(const SearchServer& search_server)
+    : search_server_(search_server) {
+}
+
+vector<Document> InstrumentedSearchServer::FindTopDocuments(string_view raw_query, DocumentStatus status,
+    size_t max_result_count) const {
+    return FindTopDocuments(execution::seq, raw_query, status, max_result_count);
+}
+
+vector<Document> InstrumentedSearchServer::FindTopDocuments(string_view raw_query) const {
+    return FindTopDocuments(execution::seq, raw_query);
+}
+
+vector<Document> InstrumentedSearchServer::FindTopDocuments(const PreparedQuery& query, DocumentStatus status,
+    size_t max_result_count) const {
+    return FindTopDocuments(execution::seq, query, status, max_result_count);
+}
+
+vector<Document> InstrumentedSearchServer::FindTopDocuments(const PreparedQuery& query) const {
+    return FindTopDocuments(execution::seq, query);
+}
+
+const QueryStats& InstrumentedSearchServer::GetStats() const {
+    return stats_;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "cancellation.h"
+#include "document.h"
+#include "query_stats.h"
+#include "search_server.h"
+
+#include <execution>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// SearchServer that records the trace of every search into QueryStats. The
+// overloads mirror SearchServer::FindTopDocuments and run its traced
+// counterparts with a RecordingQueryTracer, so the plain server keeps paying
+// nothing for the stats. Searches that throw are not recorded.
+//
+// Recording is lock-free: any number of threads may search and read the
+// stats at once.
+class InstrumentedSearchServer {
+public:
+    explicit InstrumentedSearchServer(const SearchServer& search_server);
+
+    template<typename KeyMapper>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, KeyMapper key_mapper,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
+
+    template<typename ExecutionPolicy, typename KeyMapper>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, KeyMapper key_mapper,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    template<typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentStatus status,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    template<typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query) const;
+
+    template<typename KeyMapper>
+    std::vector<Document> FindTopDocuments(const PreparedQuery& query, KeyMapper key_mapper,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(const PreparedQuery& query, DocumentStatus status,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(const PreparedQuery& query) const;
+
+    template<typename ExecutionPolicy, typename KeyMapper>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, const PreparedQuery& query, KeyMapper key_mapper,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    template<typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, const PreparedQuery& query, DocumentStatus status,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    template<typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, const PreparedQuery& query) const;
+
+    template<typename ExecutionPolicy, typename KeyMapper>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, KeyMapper key_mapper,
+        size_t max_result_count, const CancellationToken& cancellation_token) const;
+
+    template<typename ExecutionPolicy, typename KeyMapper>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, KeyMapper key_mapper,
+        size_t max_result_count, const CorpusStatistics& corpus_statistics) const;
+
+    const QueryStats& GetStats() const;
+
+private:
+    const SearchServer& search_server_;
+    mutable QueryStats stats_;
+
+    // Runs search(tracer) and records its trace once it returns
+    template<typename Search>
+    std::vector<Document> Record(Search search) const;
+};
+
+template<typename Search>
+std::vector<Document> InstrumentedSearchServer::Record(Search search) const {
+    RecordingQueryTracer tracer;
+    std::vector<Document> documents = search(tracer);
+    stats_.Record(tracer.GetTrace());
+    return documents;
+}
+
+template<typename KeyMapper>
+std::vector<Document> InstrumentedSearchServer::FindTopDocuments(std::string_view raw_query, KeyMapper key_mapper,
+    size_t max_result_count) const {
+    return FindTopDocuments(std::execution::seq, raw_query, key_mapper, max_result_count);
+}
+
+template<typename ExecutionPolicy, typename KeyMapper>
+std::vector<Document> InstrumentedSearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+    KeyMapper key_mapper, size_t max_result_count) const {
+    return Record([&](RecordingQueryTracer& tracer) {
+        return search_server_.FindTopDocumentsTraced(policy, raw_query, key_mapper, max_result_count, tracer);
+    });
+}
+
+template<typename ExecutionPolicy>
+std::vector<Document> InstrumentedSearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+    DocumentStatus status, size_t max_result_count) const {
+    return FindTopDocuments(policy, raw_query, DocumentStatusFilter{ status }, max_result_count);
+}
+
+template<typename ExecutionPolicy>
+std::vector<Document> InstrumentedSearchServer::FindTopDocuments(ExecutionPolicy&& policy,
+    std::string_view raw_query) const {
+    return FindTopDocuments(policy, raw_query, DocumentStatus::ACTUAL);
+}
+
+template<typename KeyMapper>
+std::vector<Document> InstrumentedSearchServer::FindTopDocuments(const PreparedQuery& query, KeyMapper key_mapper,
+    size_t max_result_count) const {
+    return FindTopDocuments(std::execution::seq, query, key_mapper, max_result_count);
+}
+
+template<typename ExecutionPolicy, typename KeyMapper>
+std::vector<Document> InstrumentedSearchServer::FindTopDocuments(ExecutionPolicy&& policy, const PreparedQuery& query,
+    KeyMapper key_mapper, size_t max_result_count) const {
+    return Record([&](RecordingQueryTracer& tracer) {
+        return search_server_.FindTopDocumentsTraced(policy, query, key_mapper, max_result_count, tracer);
+    });
+}
+
+template<typename ExecutionPolicy>
+std::vector<Document> InstrumentedSearchServer::FindTopDocuments(ExecutionPolicy&& policy, const PreparedQuery& query,
+    DocumentStatus status, size_t max_result_count) const {
+    return FindTopDocuments(policy, query, DocumentStatusFilter{ status }, max_result_count);
+}
+
+template<typename ExecutionPolicy>
+std::vector<Document> InstrumentedSearchServer::FindTopDocuments(ExecutionPolicy&& policy,
+    const PreparedQuery& query) const {
+    return FindTopDocuments(policy, query, DocumentStatus::ACTUAL);
+}
+
+template<typename ExecutionPolicy, typename KeyMapper>
+std::vector<Document> InstrumentedSearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+    KeyMapper key_mapper, size_t max_result_count, const CancellationToken& cancellation_token) const {
+    return Record([&](RecordingQueryTracer& tracer) {
+        return search_server_.FindTopDocumentsTraced(policy, raw_query, key_mapper, max_result_count,
+            cancellation_token, tracer);
+    });
+}
+
+template<typename ExecutionPolicy, typename KeyMapper>
+std::vector<Document> InstrumentedSearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+    KeyMapper key_mapper, size_t max_result_count, const CorpusStatistics& corpus_statistics) const {
+    return Record([&](RecordingQueryTracer& tracer) {
+        return search_server_.FindTopDocumentsTraced(policy, raw_query, key_mapper, max_result_count,
+            corpus_statistics, tracer);
+    });
+}
@@ -0,0 +1,390 @@
+#include "inverted_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+
+using namespace std;
+
+void InvertedIndex::PostingList::Cursor::SkipTo(int document) {
+    const vector<int>& documents = postings_->documents;
+    size_t block_end = min(documents.size(), (position_ / BLOCK_SIZE + 1) * BLOCK_SIZE);
+    while (block_end < documents.size() && documents[block_end - 1] < document) {
+        position_ = block_end;
+        block_end = min(documents.size(), block_end + BLOCK_SIZE);
+    }
+    position_ = lower_bound(documents.begin() + position_, documents.begin() + block_end, document) - documents.begin();
+}
+
+InvertedIndex::PostingList::Cursor InvertedIndex::PostingList::begin() const {
+    return Cursor(*this);
+}
+
+double InvertedIndex::PostingList::GetMaxTermFreq() const {
+    return max_term_freq;
+}
+
+size_t InvertedIndex::PostingList::size() const {
+    return documents.size();
+}
+
+bool InvertedIndex::PostingList::empty() const {
+    return documents.empty();
+}
+
+size_t InvertedIndex::PostingList::LowerBound(int document) const {
+    return lower_bound(documents.begin(), documents.end(), document) - documents.begin();
+}
+
+bool InvertedIndex::PostingList::Contains(int document) const {
+    return binary_search(documents.begin(), documents.end(), document);
+}
+
+void InvertedIndex::PostingList::Insert(int document, double term_freq) {
+    // Documents usually grow, so the common case is a plain append
+    if (empty() || documents.back() < document) {
+        documents.push_back(document);
+        term_freqs.push_back(term_freq);
+        if ((size() - 1) % BLOCK_SIZE == 0) {
+            block_max_term_freqs.push_back(term_freq);
+        }
+        else {
+            block_max_term_freqs.back() = max(block_max_term_freqs.back(), term_freq);
+        }
+        max_term_freq = max(max_term_freq, term_freq);
+        return;
+    }
+    const size_t position = LowerBound(document);
+    documents.insert(documents.begin() + position, document);
+    term_freqs.insert(term_freqs.begin() + position, term_freq);
+    UpdateBlocks(position);
+}
+
+void InvertedIndex::PostingList::Renumber(const vector<int>& new_documents) {
+    size_t new_size = 0;
+    for (size_t i = 0; i < size(); ++i) {
+        const int new_document = new_documents[documents[i]];
+        if (new_document >= 0) {
+            documents[new_size] = new_document;
+            term_freqs[new_size] = term_freqs[i];
+            ++new_size;
+        }
+    }
+    documents.resize(new_size);
+    term_freqs.resize(new_size);
+    UpdateBlocks(0);
+}
+
+bool InvertedIndex::PostingList::HasConsistentBlocks() const {
+    if (term_freqs.size() != size() || block_max_term_freqs.size() != (size() + BLOCK_SIZE - 1) / BLOCK_SIZE) {
+        return false;
+    }
+    for (size_t block = 0; block < block_max_term_freqs.size(); ++block) {
+        const size_t block_begin = block * BLOCK_SIZE;
+        const size_t block_end = min(size(), block_begin + BLOCK_SIZE);
+        if (block_max_term_freqs[block] != *max_element(term_freqs.begin() + block_begin, term_freqs.begin() + block_end)) {
+            return false;
+        }
+    }
+    return max_term_freq == (block_max_term_freqs.empty()
+        ? 0.0
+        : *max_element(block_max_term_freqs.begin(), block_max_term_freqs.end()));
+}
+
+void InvertedIndex::PostingList::UpdateBlocks(size_t position) {
+    // Shifting postings moves every later block boundary, so all of them are redone
+    size_t block_begin = position / BLOCK_SIZE * BLOCK_SIZE;
+    block_max_term_freqs.resize(block_begin / BLOCK_SIZE);
+    for (; block_begin < size(); block_begin += BLOCK_SIZE) {
+        const size_t block_end = min(size(), block_begin + BLOCK_SIZE);
+        block_max_term_freqs.push_back(
+            *max_element(term_freqs.begin() + block_begin, term_freqs.begin() + block_end));
+    }
+    max_term_freq = block_max_term_freqs.empty()
+        ? 0.0
+        : *max_element(block_max_term_freqs.begin(), block_max_term_freqs.end());
+}
+
+void InvertedIndex::TermPostings::UpdateDocumentFreq(size_t new_document_freq) {
+    document_freq = new_document_freq;
+    log_document_freq = log(static_cast<double>(document_freq));
+}
+
+InvertedIndex::InvertedIndex(const InvertedIndex& other)
+    : terms_(other.terms_), postings_(other.postings_), document_words_(other.document_words_)
+    , is_compressed_(other.is_compressed_) {
+    RebindTerms();
+}
+
+InvertedIndex& InvertedIndex::operator=(const InvertedIndex& other) {
+    if (this != &other) {
+        terms_ = other.terms_;
+        postings_ = other.postings_;
+        document_words_ = other.document_words_;
+        is_compressed_ = other.is_compressed_;
+        RebindTerms();
+    }
+    return *this;
+}
+
+InvertedIndex::TermId InvertedIndex::FindTerm(string_view word) const {
+    const auto it = term_ids_.find(word);
+    return it == term_ids_.end() ? NO_TERM : it->second;
+}
+
+InvertedIndex::TermId InvertedIndex::AddTerm(string_view word) {
+    const auto it = term_ids_.find(word);
+    if (it != term_ids_.end()) {
+        return it->second;
+    }
+    const TermId term = static_cast<TermId>(terms_.size());
+    terms_.emplace_back(word);
+    postings_.emplace_back();
+    term_ids_.emplace(terms_.back(), term);
+    return term;
+}
+
+string_view InvertedIndex::GetTerm(TermId term) const {
+    return terms_[term];
+}
+
+size_t InvertedIndex::GetTermCount() const {
+    return terms_.size();
+}
+
+const InvertedIndex::PostingList& InvertedIndex::GetPostings(TermId term, DocumentStatus status) const {
+    return postings_[term].by_status[static_cast<size_t>(status)];
+}
+
+const CompressedPostingList& InvertedIndex::GetCompressedPostings(TermId term, DocumentStatus status) const {
+    return postings_[term].compressed_by_status[static_cast<size_t>(status)];
+}
+
+bool InvertedIndex::ContainsPosting(TermId term, DocumentStatus status, int document) const {
+    return is_compressed_
+        ? GetCompressedPostings(term, status).Contains(document)
+        : GetPostings(term, status).Contains(document);
+}
+
+void InvertedIndex::Compress() {
+    if (is_compressed_) {
+        return;
+    }
+    for (TermPostings& term_postings : postings_) {
+        for (size_t status = 0; status < STATUS_COUNT; ++status) {
+            const PostingList& postings = term_postings.by_status[status];
+            term_postings.compressed_by_status[status] = CompressedPostingList(postings.documents, postings.term_freqs);
+            term_postings.by_status[status] = PostingList();
+        }
+    }
+    is_compressed_ = true;
+}
+
+bool InvertedIndex::IsCompressed() const {
+    return is_compressed_;
+}
+
+size_t InvertedIndex::GetPostingMemoryUsage() const {
+    size_t memory_usage = 0;
+    for (const TermPostings& term_postings : postings_) {
+        for (size_t status = 0; status < STATUS_COUNT; ++status) {
+            if (is_compressed_) {
+                memory_usage += term_postings.compressed_by_status[status].GetMemoryUsage();
+            }
+            else {
+                const PostingList& postings = term_postings.by_status[status];
+                memory_usage += postings.documents.capacity() * sizeof(int)
+                    + (postings.term_freqs.capacity() + postings.block_max_term_freqs.capacity()) * sizeof(double);
+            }
+        }
+    }
+    return memory_usage;
+}
+
+InvertedIndex::PostingList InvertedIndex::DecompressPostings(const CompressedPostingList& compressed_postings) {
+    PostingList postings;
+    postings.documents.reserve(compressed_postings.size());
+    postings.term_freqs.reserve(compressed_postings.size());
+    for (auto cursor = compressed_postings.begin(); !cursor.AtEnd(); cursor.Next()) {
+        postings.Insert(cursor.GetDocument(), cursor.GetTermFreq());
+    }
+    return postings;
+}
+
+void InvertedIndex::Decompress() {
+    for (TermPostings& term_postings : postings_) {
+        for (size_t status = 0; status < STATUS_COUNT; ++status) {
+            term_postings.by_status[status] = DecompressPostings(term_postings.compressed_by_status[status]);
+            term_postings.compressed_by_status[status] = CompressedPostingList();
+        }
+    }
+    is_compressed_ = false;
+}
+
+size_t InvertedIndex::GetDocumentFreq(TermId term) const {
+    return postings_[term].document_freq;
+}
+
+double InvertedIndex::GetLogDocumentFreq(TermId term) const {
+    return postings_[term].log_document_freq;
+}
+
+void InvertedIndex::AddDocument(int document, DocumentStatus status, map<string_view, double> word_freqs) {
+    if (is_compressed_) {
+        Decompress();
+    }
+    DocumentWords& document_words = document_words_[document];
+    document_words.status = status;
+    while (!word_freqs.empty()) {
+        auto word_node = word_freqs.extract(word_freqs.begin());
+        const TermId term = AddTerm(word_node.key());
+        TermPostings& postings = postings_[term];
+        postings.by_status[static_cast<size_t>(status)].Insert(document, word_node.mapped());
+        postings.UpdateDocumentFreq(postings.document_freq + 1);
+        // Same word, so the order of the map is kept
+        word_node.key() = terms_[term];
+        document_words.word_freqs.insert(document_words.word_freqs.end(), move(word_node));
+    }
+}
+
+void InvertedIndex::RemoveDocument(int document) {
+    const auto document_it = document_words_.find(document);
+    if (document_it == document_words_.end()) {
+        return;
+    }
+    for (const auto& [word, _] : document_it->second.word_freqs) {
+        TermPostings& postings = postings_[term_ids_.at(word)];
+        postings.UpdateDocumentFreq(postings.document_freq - 1);
+    }
+    document_words_.erase(document_it);
+}
+
+const map<string_view, double>& InvertedIndex::GetWordFrequencies(int document) const {
+    static const map<string_view, double> empty_word_freqs;
+    const auto it = document_words_.find(document);
+    return it == document_words_.end() ? empty_word_freqs : it->second.word_freqs;
+}
+
+void InvertedIndex::SaveTo(SnapshotWriter& writer, const vector<int>& new_documents) const {
+    writer.Write<uint64_t>(terms_.size());
+    for (size_t term = 0; term < terms_.size(); ++term) {
+        writer.WriteString(terms_[term]);
+        for (size_t status = 0; status < STATUS_COUNT; ++status) {
+            PostingList postings = is_compressed_
+                ? DecompressPostings(postings_[term].compressed_by_status[status])
+                : postings_[term].by_status[status];
+            postings.Renumber(new_documents);
+            writer.WriteArray(postings.documents);
+            writer.WriteArray(postings.term_freqs);
+            writer.WriteArray(postings.block_max_term_freqs);
+            writer.Write(postings.max_term_freq);
+        }
+    }
+}
+
+InvertedIndex InvertedIndex::LoadFrom(SnapshotReader& reader, size_t document_count) {
+    InvertedIndex index;
+    const uint64_t term_count = reader.Read<uint64_t>();
+    for (uint64_t i = 0; i < term_count; ++i) {
+        const TermId term = index.AddTerm(reader.ReadString());
+        TermPostings& term_postings = index.postings_[term];
+        size_t document_freq = 0;
+        for (PostingList& postings : term_postings.by_status) {
+            postings.documents = reader.ReadArray<int>();
+            postings.term_freqs = reader.ReadArray<double>();
+            postings.block_max_term_freqs = reader.ReadArray<double>();
+            postings.max_term_freq = reader.Read<double>();
+            // Searches skip blocks by their maxima, so wrong ones would silently drop results
+            if (!postings.HasConsistentBlocks()) {
+                throw runtime_error("Snapshot has inconsistent postings");
+            }
+            if (adjacent_find(postings.documents.begin(), postings.documents.end(), greater_equal<int>())
+                != postings.documents.end()) {
+                throw runtime_error("Snapshot has unsorted postings");
+            }
+            document_freq += postings.size();
+        }
+        term_postings.UpdateDocumentFreq(document_freq);
+    }
+    if (index.terms_.size() != term_count) {
+        throw runtime_error("Snapshot has duplicate terms");
+    }
+
+    // The forward map is rebuilt without searching any tree: postings are first
+    // bucketed by document, visiting terms in word order, so every map is then
+    // filled by appends, and documents are appended in increasing order too
+    vector<TermId> terms_by_word(index.terms_.size());
+    for (size_t term = 0; term < terms_by_word.size(); ++term) {
+        terms_by_word[term] = static_cast<TermId>(term);
+    }
+    sort(terms_by_word.begin(), terms_by_word.end(),
+        [&index](TermId lhs, TermId rhs) {
+            return index.terms_[lhs] < index.terms_[rhs];
+        });
+
+    vector<size_t> document_offsets(document_count + 1);
+    for (const TermPostings& term_postings : index.postings_) {
+        for (const PostingList& postings : term_postings.by_status) {
+            for (int document : postings.documents) {
+                if (document < 0 || static_cast<size_t>(document) >= document_count) {
+                    throw runtime_error("Snapshot has a posting of an unknown document");
+                }
+                ++document_offsets[document + 1];
+            }
+        }
+    }
+    for (size_t i = 1; i < document_offsets.size(); ++i) {
+        document_offsets[i] += document_offsets[i - 1];
+    }
+
+    struct DocumentPosting {
+        TermId term;
+        uint8_t status;
+        double term_freq;
+    };
+    vector<DocumentPosting> document_postings(document_offsets.empty() ? 0 : document_offsets.back());
+    vector<size_t> next_positions(document_offsets);
+    for (TermId term : terms_by_word) {
+        for (size_t status = 0; status < STATUS_COUNT; ++status) {
+            const PostingList& postings = index.postings_[term].by_status[status];
+            for (size_t i = 0; i < postings.size(); ++i) {
+                document_postings[next_positions[postings.documents[i]]++] =
+                    { term, static_cast<uint8_t>(status), postings.term_freqs[i] };
+            }
+        }
+    }
+
+    for (size_t document = 0; document + 1 < document_offsets.size(); ++document) {
+        if (document_offsets[document] == document_offsets[document + 1]) {
+            continue;
+        }
+        DocumentWords& document_words = index.document_words_.emplace_hint(index.document_words_.end(),
+            static_cast<int>(document), DocumentWords{})->second;
+        const uint8_t status = document_postings[document_offsets[document]].status;
+        document_words.status = static_cast<DocumentStatus>(status);
+        for (size_t i = document_offsets[document]; i < document_offsets[document + 1]; ++i) {
+            if (document_postings[i].status != status) {
+                throw runtime_error("Snapshot has a document in several status partitions");
+            }
+            document_words.word_freqs.emplace_hint(document_words.word_freqs.end(),
+                index.terms_[document_postings[i].term], document_postings[i].term_freq);
+        }
+    }
+    return index;
+}
+
+void InvertedIndex::RebindTerms() {
+    term_ids_.clear();
+    term_ids_.reserve(terms_.size());
+    for (size_t term = 0; term < terms_.size(); ++term) {
+        term_ids_.emplace(terms_[term], static_cast<TermId>(term));
+    }
+    for (auto& [_, document_words] : document_words_) {
+        map<string_view, double> own_word_freqs;
+        for (const auto& [word, term_freq] : document_words.word_freqs) {
+            own_word_freqs.emplace_hint(own_word_freqs.end(), terms_[term_ids_.at(word)], term_freq);
+        }
+        document_words.word_freqs = move(own_word_freqs);
+    }
+}
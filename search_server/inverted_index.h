@@ -0,0 +1,413 @@
+#pragma once
+
+#include "compressed_posting_list.h"
+#include "document.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <execution>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Term dictionary plus postings. Every distinct word is stored once and gets a
+// dense id; postings of a term are kept as two parallel arrays sorted by
+// document, so a scan walks contiguous memory. A forward map from document
+// to its words lets a document be removed by touching only its own terms.
+//
+// Removing a document only updates the document frequencies of its words:
+// its postings stay behind as tombstones, which the owner has to skip, until
+// Compact drops all of them in one pass.
+//
+// Postings of a term are partitioned by document status: a search limited to
+// one status reads only that partition and never sees the other documents.
+//
+// Compress swaps every posting list for a CompressedPostingList, for an
+// index that is done growing. Adding a document decompresses it again.
+//
+// Documents are non-negative keys chosen by the owner. SearchServer uses
+// ordinals (order of addition), which makes adding a posting an append.
+class InvertedIndex {
+public:
+    using TermId = uint32_t;
+
+    static constexpr TermId NO_TERM = std::numeric_limits<TermId>::max();
+
+    static constexpr size_t STATUS_COUNT = static_cast<size_t>(DocumentStatus::REMOVED) + 1;
+
+    struct PostingList {
+        // Postings are grouped in blocks of BLOCK_SIZE to bound the scores of a block
+        static constexpr size_t BLOCK_SIZE = 64;
+
+        std::vector<int> documents;
+        std::vector<double> term_freqs;
+        std::vector<double> block_max_term_freqs;
+        double max_term_freq = 0.0;
+
+        // Forward cursor over the postings in document order. Searches are
+        // written against it, so they run on CompressedPostingList::Cursor too.
+        class Cursor {
+        public:
+            explicit Cursor(const PostingList& postings)
+                : postings_(&postings) {
+            }
+
+            bool AtEnd() const {
+                return position_ == postings_->documents.size();
+            }
+
+            int GetDocument() const {
+                return postings_->documents[position_];
+            }
+
+            double GetTermFreq() const {
+                return postings_->term_freqs[position_];
+            }
+
+            // Largest term frequency of the block the cursor is in
+            double GetBlockMaxTermFreq() const {
+                return postings_->block_max_term_freqs[position_ / BLOCK_SIZE];
+            }
+
+            void Next() {
+                ++position_;
+            }
+
+            // Moves to the first posting not less than document, jumping over whole blocks
+            void SkipTo(int document);
+
+        private:
+            const PostingList* postings_;
+            size_t position_ = 0;
+        };
+
+        Cursor begin() const;
+
+        double GetMaxTermFreq() const;
+
+        size_t size() const;
+
+        bool empty() const;
+
+        // Position of the first posting not less than document
+        size_t LowerBound(int document) const;
+
+        bool Contains(int document) const;
+
+        // A document is expected to be inserted once
+        void Insert(int document, double term_freq);
+
+        // Replaces every document with new_documents[document], dropping the
+        // ones mapped to -1. The mapping must keep the documents in order.
+        void Renumber(const std::vector<int>& new_documents);
+
+        // Whether the block maxima and max_term_freq are the ones the
+        // term frequencies give, as after any change made by the methods
+        bool HasConsistentBlocks() const;
+
+    private:
+        // Recomputes the block maxima from the block holding position onwards
+        void UpdateBlocks(size_t position);
+    };
+
+    InvertedIndex() = default;
+
+    InvertedIndex(const InvertedIndex& other);
+
+    InvertedIndex& operator=(const InvertedIndex& other);
+
+    InvertedIndex(InvertedIndex&& other) = default;
+
+    InvertedIndex& operator=(InvertedIndex&& other) = default;
+
+    TermId FindTerm(std::string_view word) const;
+
+    // The view stays valid for the lifetime of the index
+    std::string_view GetTerm(TermId term) const;
+
+    size_t GetTermCount() const;
+
+    // Only while the index is not compressed
+    const PostingList& GetPostings(TermId term, DocumentStatus status) const;
+
+    // Only while the index is compressed
+    const CompressedPostingList& GetCompressedPostings(TermId term, DocumentStatus status) const;
+
+    bool ContainsPosting(TermId term, DocumentStatus status, int document) const;
+
+    // Encodes every posting list compactly and frees the plain ones. Searches
+    // then read them through CompressedPostingList::Cursor.
+    void Compress();
+
+    bool IsCompressed() const;
+
+    // Bytes held by the posting lists in their current form
+    size_t GetPostingMemoryUsage() const;
+
+    // Number of documents of any status containing the term, not counting
+    // removed ones whose postings are still there
+    size_t GetDocumentFreq(TermId term) const;
+
+    // Kept up to date on every change, so IDF costs the query a subtraction
+    double GetLogDocumentFreq(TermId term) const;
+
+    // Keys of word_freqs may point anywhere: the map's nodes are reused for the
+    // forward map with their keys pointed into the dictionary. A compressed
+    // index is decompressed first.
+    void AddDocument(int document, DocumentStatus status, std::map<std::string_view, double> word_freqs);
+
+    struct NewDocument {
+        DocumentStatus status;
+        std::map<std::string_view, double> word_freqs;
+    };
+
+    // Same as AddDocument for documents first_document, first_document + 1, ...
+    // A parallel policy indexes chunks of documents into partial indexes at
+    // once and then merges them term by term, also at once. Only adding new
+    // words to the dictionary is sequential.
+    template <typename ExecutionPolicy>
+    void AddDocuments(ExecutionPolicy&& policy, int first_document, std::vector<NewDocument> documents);
+
+    // The postings of the document are left for Compact
+    void RemoveDocument(int document);
+
+    // Renumbers documents as PostingList::Renumber does, which drops the
+    // postings of removed documents mapped to -1. Postings of different terms
+    // are independent, so a parallel policy compacts them at once. A
+    // compressed index stays compressed.
+    template <typename ExecutionPolicy>
+    void Compact(ExecutionPolicy&& policy, const std::vector<int>& new_documents);
+
+    // Keys point into the dictionary. Unknown documents get an empty map.
+    const std::map<std::string_view, double>& GetWordFrequencies(int document) const;
+
+    // Writes the dictionary and the postings renumbered by new_documents, as
+    // Compact would leave them. The forward map is not written: LoadFrom
+    // rebuilds it from the postings.
+    void SaveTo(SnapshotWriter& writer, const std::vector<int>& new_documents) const;
+
+    // Throws std::runtime_error unless every posting list is sorted and has
+    // the block maxima of its term frequencies, every document is below
+    // document_count and each document is in one status partition, so a
+    // loaded index is safe to search
+    static InvertedIndex LoadFrom(SnapshotReader& reader, size_t document_count);
+
+private:
+    struct TermPostings {
+        std::array<PostingList, STATUS_COUNT> by_status;
+        // Used instead of by_status, which is empty, while the index is compressed
+        std::array<CompressedPostingList, STATUS_COUNT> compressed_by_status;
+        size_t document_freq = 0;
+        double log_document_freq = -std::numeric_limits<double>::infinity();
+
+        void UpdateDocumentFreq(size_t new_document_freq);
+    };
+
+    struct DocumentWords {
+        DocumentStatus status;
+        std::map<std::string_view, double> word_freqs;
+    };
+
+    // std::deque never relocates its elements, so views into them stay valid
+    std::deque<std::string> terms_;
+    std::unordered_map<std::string_view, TermId> term_ids_;
+    std::vector<TermPostings> postings_;
+    std::map<int, DocumentWords> document_words_;
+    bool is_compressed_ = false;
+
+    static PostingList DecompressPostings(const CompressedPostingList& compressed_postings);
+
+    // Turns the compressed posting lists back into plain ones
+    void Decompress();
+
+    // Returns the id of the word, adding it to the dictionary if needed
+    TermId AddTerm(std::string_view word);
+
+    // Points the term ids and the forward map at this object's own dictionary
+    void RebindTerms();
+};
+
+template <typename ExecutionPolicy>
+void InvertedIndex::AddDocuments(ExecutionPolicy&& policy, int first_document, std::vector<NewDocument> documents) {
+    if (is_compressed_) {
+        Decompress();
+    }
+    if constexpr (std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>) {
+        for (size_t i = 0; i < documents.size(); ++i) {
+            AddDocument(first_document + static_cast<int>(i), documents[i].status, std::move(documents[i].word_freqs));
+        }
+    }
+    else {
+        if (documents.empty()) {
+            return;
+        }
+
+        struct Posting {
+            int document;
+            DocumentStatus status;
+            double term_freq;
+        };
+        // Index of a chunk of documents. Its words are numbered in the order
+        // the documents bring them.
+        struct PartialIndex {
+            std::vector<std::string_view> words;
+            std::vector<TermId> terms;
+            // Word of every posting, in the order of the documents and their words
+            std::vector<uint32_t> posting_words;
+            // Postings grouped by word, word i owns [word_offsets[i], word_offsets[i + 1])
+            std::vector<Posting> postings;
+            std::vector<size_t> word_offsets;
+            // Words ordered by term
+            std::vector<uint32_t> words_by_term;
+        };
+
+        const size_t chunk_count = std::min<size_t>(documents.size(),
+            std::max(1u, std::thread::hardware_concurrency()) * 4);
+        const size_t chunk_size = (documents.size() + chunk_count - 1) / chunk_count;
+        std::vector<PartialIndex> partial_indexes(chunk_count);
+        std::vector<size_t> chunks(chunk_count);
+        std::iota(chunks.begin(), chunks.end(), 0);
+        // The dictionary is only read here, so the chunks look their words up at once
+        std::for_each(policy, chunks.begin(), chunks.end(),
+            [&](size_t chunk) {
+                PartialIndex& partial_index = partial_indexes[chunk];
+                std::unordered_map<std::string_view, uint32_t> word_indexes;
+                std::vector<Posting> postings;
+                const size_t chunk_end = std::min(documents.size(), (chunk + 1) * chunk_size);
+                for (size_t i = chunk * chunk_size; i < chunk_end; ++i) {
+                    for (const auto& [word, term_freq] : documents[i].word_freqs) {
+                        const auto [it, is_new_word] = word_indexes.emplace(word,
+                            static_cast<uint32_t>(partial_index.words.size()));
+                        if (is_new_word) {
+                            partial_index.words.push_back(word);
+                            partial_index.terms.push_back(FindTerm(word));
+                        }
+                        postings.push_back({ first_document + static_cast<int>(i), documents[i].status, term_freq });
+                        partial_index.posting_words.push_back(it->second);
+                    }
+                }
+
+                // Counting sort by word keeps the postings of a word in document order
+                partial_index.word_offsets.assign(partial_index.words.size() + 1, 0);
+                for (uint32_t word : partial_index.posting_words) {
+                    ++partial_index.word_offsets[word + 1];
+                }
+                std::partial_sum(partial_index.word_offsets.begin(), partial_index.word_offsets.end(),
+                    partial_index.word_offsets.begin());
+                std::vector<size_t> next_positions(partial_index.word_offsets.begin(), partial_index.word_offsets.end() - 1);
+                partial_index.postings.resize(postings.size());
+                for (size_t posting = 0; posting < postings.size(); ++posting) {
+                    partial_index.postings[next_positions[partial_index.posting_words[posting]]++] = postings[posting];
+                }
+            });
+
+        // Walking the chunks in order adds the new words to the dictionary in
+        // the order one by one additions would
+        for (PartialIndex& partial_index : partial_indexes) {
+            for (size_t word = 0; word < partial_index.words.size(); ++word) {
+                if (partial_index.terms[word] == NO_TERM) {
+                    partial_index.terms[word] = AddTerm(partial_index.words[word]);
+                }
+            }
+        }
+
+        // The dictionary no longer changes: forward maps are pointed into it
+        // without looking words up, and only linked into document_words_ in order
+        std::vector<DocumentWords> new_document_words(documents.size());
+        std::for_each(policy, chunks.begin(), chunks.end(),
+            [&](size_t chunk) {
+                PartialIndex& partial_index = partial_indexes[chunk];
+                partial_index.words_by_term.resize(partial_index.words.size());
+                std::iota(partial_index.words_by_term.begin(), partial_index.words_by_term.end(), 0);
+                std::sort(partial_index.words_by_term.begin(), partial_index.words_by_term.end(),
+                    [&partial_index](uint32_t lhs, uint32_t rhs) {
+                        return partial_index.terms[lhs] < partial_index.terms[rhs];
+                    });
+
+                size_t posting = 0;
+                const size_t chunk_end = std::min(documents.size(), (chunk + 1) * chunk_size);
+                for (size_t i = chunk * chunk_size; i < chunk_end; ++i) {
+                    std::map<std::string_view, double>& word_freqs = documents[i].word_freqs;
+                    DocumentWords& document_words = new_document_words[i];
+                    document_words.status = documents[i].status;
+                    while (!word_freqs.empty()) {
+                        auto word_node = word_freqs.extract(word_freqs.begin());
+                        word_node.key() = terms_[partial_index.terms[partial_index.posting_words[posting++]]];
+                        document_words.word_freqs.insert(document_words.word_freqs.end(), std::move(word_node));
+                    }
+                }
+            });
+
+        // Every task merges the postings of a range of terms, taking the
+        // chunks in order, so each posting list gets a run of appends
+        const size_t term_range_count = chunk_count;
+        const size_t term_range_size = terms_.size() / term_range_count + 1;
+        std::vector<size_t> term_ranges(term_range_count);
+        std::iota(term_ranges.begin(), term_ranges.end(), 0);
+        std::for_each(policy, term_ranges.begin(), term_ranges.end(),
+            [&](size_t term_range) {
+                const TermId range_begin = static_cast<TermId>(term_range * term_range_size);
+                const TermId range_end = static_cast<TermId>(std::min(terms_.size(), (term_range + 1) * term_range_size));
+                for (const PartialIndex& partial_index : partial_indexes) {
+                    const auto by_term = [&partial_index](uint32_t word, TermId term) {
+                        return partial_index.terms[word] < term;
+                    };
+                    for (auto it = std::lower_bound(partial_index.words_by_term.begin(),
+                        partial_index.words_by_term.end(), range_begin, by_term);
+                        it != partial_index.words_by_term.end() && partial_index.terms[*it] < range_end; ++it) {
+                        TermPostings& term_postings = postings_[partial_index.terms[*it]];
+                        const size_t postings_begin = partial_index.word_offsets[*it];
+                        const size_t postings_end = partial_index.word_offsets[*it + 1];
+                        for (size_t posting = postings_begin; posting < postings_end; ++posting) {
+                            const Posting& new_posting = partial_index.postings[posting];
+                            term_postings.by_status[static_cast<size_t>(new_posting.status)].Insert(
+                                new_posting.document, new_posting.term_freq);
+                        }
+                        term_postings.UpdateDocumentFreq(term_postings.document_freq + postings_end - postings_begin);
+                    }
+                }
+            });
+
+        for (size_t i = 0; i < new_document_words.size(); ++i) {
+            document_words_.emplace_hint(document_words_.end(), first_document + static_cast<int>(i),
+                std::move(new_document_words[i]));
+        }
+    }
+}
+
+template <typename ExecutionPolicy>
+void InvertedIndex::Compact(ExecutionPolicy&& policy, const std::vector<int>& new_documents) {
+    std::for_each(policy, postings_.begin(), postings_.end(),
+        [this, &new_documents](TermPostings& postings) {
+            if (is_compressed_) {
+                for (CompressedPostingList& status_postings : postings.compressed_by_status) {
+                    PostingList plain_postings = DecompressPostings(status_postings);
+                    plain_postings.Renumber(new_documents);
+                    status_postings = CompressedPostingList(plain_postings.documents, plain_postings.term_freqs);
+                }
+            }
+            else {
+                for (PostingList& status_postings : postings.by_status) {
+                    status_postings.Renumber(new_documents);
+                }
+            }
+        });
+
+    // Documents keep their order, so the nodes are appended to the new map
+    std::map<int, DocumentWords> document_words;
+    while (!document_words_.empty()) {
+        auto document_node = document_words_.extract(document_words_.begin());
+        document_node.key() = new_documents[document_node.key()];
+        document_words.insert(document_words.end(), std::move(document_node));
+    }
+    document_words_ = std::move(document_words);
+}
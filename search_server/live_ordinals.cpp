@@ -0,0 +1,84 @@
+#include "live_ordinals.h"
+
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+size_t LowestBit(size_t value) {
+    return value & (~value + 1);
+}
+
+}
+
+LiveOrdinals::LiveOrdinals(const vector<bool>& is_live)
+    : is_live_(is_live), live_counts_(is_live.size() + 1, 0) {
+    // Every entry passes its count on to the entry covering it, O(n) in total
+    for (size_t i = 1; i < live_counts_.size(); ++i) {
+        if (is_live_[i - 1]) {
+            ++live_counts_[i];
+            ++live_count_;
+        }
+        const size_t parent = i + LowestBit(i);
+        if (parent < live_counts_.size()) {
+            live_counts_[parent] += live_counts_[i];
+        }
+    }
+}
+
+void LiveOrdinals::PushBack() {
+    // The new entry covers itself and the entries right below it that end
+    // inside its range
+    const size_t i = live_counts_.size();
+    int live_count = 1;
+    for (size_t j = i - 1; j > i - LowestBit(i); j -= LowestBit(j)) {
+        live_count += live_counts_[j];
+    }
+    is_live_.push_back(true);
+    live_counts_.push_back(live_count);
+    ++live_count_;
+}
+
+void LiveOrdinals::Remove(int ordinal) {
+    is_live_[ordinal] = false;
+    for (size_t i = static_cast<size_t>(ordinal) + 1; i < live_counts_.size(); i += LowestBit(i)) {
+        --live_counts_[i];
+    }
+    --live_count_;
+}
+
+size_t LiveOrdinals::size() const {
+    return is_live_.size();
+}
+
+size_t LiveOrdinals::GetLiveCount() const {
+    return live_count_;
+}
+
+int LiveOrdinals::Select(size_t index) const {
+    if (index >= live_count_) {
+        throw out_of_range("No live ordinal at index "s + to_string(index));
+    }
+    if (live_count_ == is_live_.size()) {
+        return static_cast<int>(index);
+    }
+
+    // Descends the tree: position ends up on the last ordinal with at most
+    // index live ordinals up to it, so the next one is the answer
+    size_t step = 1;
+    while (step * 2 < live_counts_.size()) {
+        step *= 2;
+    }
+    size_t position = 0;
+    size_t remaining = index + 1;
+    for (; step > 0; step /= 2) {
+        const size_t next = position + step;
+        if (next < live_counts_.size() && static_cast<size_t>(live_counts_[next]) < remaining) {
+            position = next;
+            remaining -= live_counts_[next];
+        }
+    }
+    return static_cast<int>(position);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Which ordinals of a server still hold a document. Ordinals are appended in
+// order of addition and removing one only clears its flag, so the order of
+// the live ones is the order of addition. A Fenwick tree of live counts finds
+// the index-th live ordinal in O(log n).
+class LiveOrdinals {
+public:
+    LiveOrdinals() = default;
+
+    // Ordinals [0, is_live.size()) flagged as given
+    explicit LiveOrdinals(const std::vector<bool>& is_live);
+
+    // Appends an ordinal, live
+    void PushBack();
+
+    // The ordinal must be live
+    void Remove(int ordinal);
+
+    bool Contains(int ordinal) const {
+        return is_live_[ordinal];
+    }
+
+    // Number of ordinals, live or not
+    size_t size() const;
+
+    size_t GetLiveCount() const;
+
+    // Throws std::out_of_range unless index < GetLiveCount()
+    int Select(size_t index) const;
+
+private:
+    std::vector<bool> is_live_;
+    // 1-based: entry i counts the live ordinals in [i - (i & -i), i)
+    std::vector<int> live_counts_ = { 0 };
+    size_t live_count_ = 0;
+};
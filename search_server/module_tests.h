@@ -1,339 +1,1984 @@
-#pragma once
-
-#include <iostream>
-#include <string>
-
-/*
-    
-   ASSERT, ASSERT_EQUAL, ASSERT_EQUAL_HINT, ASSERT_HINT  RUN_TEST
-*/
-
-void AssertImpl(bool value, const std::string& expr_str, const std::string& file, const std::string& func, unsigned line,
-    const std::string& hint);
-
-template <typename T, typename U>
-void AssertEqualImpl(const T& t, const U& u, const std::string& t_str, const std::string& u_str, const std::string& file, const std::string& func, unsigned line, const std::string& hint);
-
-template <typename TestFunc>
-void RunTestImpl(const TestFunc& func, const std::string& test_name);
-
-#define ASSERT(a) AssertImpl(a,#a, __FILE__, __FUNCTION__, __LINE__, ""s)
-#define ASSERT_HINT(a, hint) AssertImpl(a,#a, __FILE__, __FUNCTION__, __LINE__, (hint))
-#define ASSERT_EQUAL(a, b) AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, ""s)
-#define ASSERT_EQUAL_HINT(a, b, hint) AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, (hint))
-#define RUN_TEST(func) RunTestImpl(func, #func)
-
-// --------      ----------
-/*
-//  ,     -   
-void TestExcludeStopWordsFromAddedDocumentContent() {
-    const int doc_id = 42;
-    const string content = "cat in the city"s;
-    const vector<int> ratings = { 1, 2, 3 };
-    {
-        SearchServer server;
-        server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
-        const auto found_docs = server.FindTopDocuments("in"s);
-        ASSERT_EQUAL(found_docs.size(), 1u);
-        const Document& doc0 = found_docs[0];
-        ASSERT_EQUAL(doc0.id, doc_id);
-    }
-
-    {
-        SearchServer server;
-        server.SetStopWords("in the"s);
-        server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
-        ASSERT_HINT(server.FindTopDocuments("in"s).empty(),
-            "Stop words must be excluded from documents"s);
-    }
-}
-//  -
-void TestFindDocumentsWithMinusWords() {
-    const int doc_id_1 = 10;
-    const string content_1 = "cat in the town"s;
-    const vector<int> ratings_1 = { 1, 2, 3 };
-
-    const int doc_id_2 = 11;
-    const string content_2 = "cat in the city"s;
-    const vector<int> ratings_2 = { 1, 2, 3 };
-
-    {
-        SearchServer server;
-        server.AddDocument(doc_id_1, content_1, DocumentStatus::ACTUAL, ratings_1);
-        server.AddDocument(doc_id_2, content_2, DocumentStatus::ACTUAL, ratings_2);
-
-        const auto found_docs = server.FindTopDocuments("cat -city"s);
-        ASSERT_EQUAL(found_docs[0].id, 10);
-        ASSERT_EQUAL(found_docs.size(), 1u);
-    }
-
-    {
-        SearchServer server;
-        server.AddDocument(doc_id_1, content_1, DocumentStatus::ACTUAL, ratings_1);
-        server.AddDocument(doc_id_2, content_2, DocumentStatus::ACTUAL, ratings_2);
-
-        const auto found_docs = server.FindTopDocuments("-cat city"s);
-        ASSERT_EQUAL(found_docs.size(), 0u);
-    }
-}
-//  
-void TestAddDocuments() {
-    const vector<int> doc_ids = { 1,2,3,4,5 };
-    const vector<string> contents = {
-        "cat in the town"s,
-        "cat in the city"s,
-        "cat eats a fish"s,
-        "cat like a fish"s,
-        "funny cat"
-    };
-    const vector<vector<int>> ratings = {
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-    };
-
-    {
-        SearchServer server;
-        for (int i = 0; i < 5; i++) {
-            server.AddDocument(doc_ids[i], contents[i], DocumentStatus::ACTUAL, ratings[i]);
-        }
-
-        const auto found_docs = server.FindTopDocuments("cat"s);
-
-        ASSERT_EQUAL(found_docs.size(), 5u);
-        for (int i = 0; i < 5; i++) {
-            ASSERT_EQUAL(found_docs[i].id, doc_ids[i]);
-        }
-    }
-}
-//  - 
-void TestGetDocumentCount() {
-    const vector<int> doc_ids = { 1,2,3,4,5 };
-    const vector<string> contents = {
-        "cat in the town"s,
-        "cat in the city"s,
-        "cat eats a fish"s,
-        "cat like a fish"s,
-        "funny cat"
-    };
-    const vector<vector<int>> ratings = {
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-    };
-
-    {
-        SearchServer server;
-        for (int i = 0; i < 5; i++) {
-            server.AddDocument(doc_ids[i], contents[i], DocumentStatus::ACTUAL, ratings[i]);
-        }
-
-        ASSERT_EQUAL(server.GetDocumentCount(), 5);
-    }
-}
-//   
-void TestComputeRelevance() {
-
-    const vector<int> doc_ids = { 0,1,2,3 };
-    const vector<string> contents = {
-        "    "s,
-        "   "s,
-        "   ",
-        "  "s,
-    };
-
-    const vector<vector<int>> ratings = {
-        {8, -3},
-        {7, 2, 7},
-        {5, -12, 2, 1},
-        {9},
-    };
-
-    const vector<double> relevance = { 0.866434, 0.231049, 0.173287, 0.173287 };
-
-    {
-        SearchServer server;
-        server.SetStopWords("  "s);
-        for (int i = 0; i < 4; i++) {
-            server.AddDocument(doc_ids[i], contents[i], DocumentStatus::ACTUAL, ratings[i]);
-        }
-
-        const auto found_docs = server.FindTopDocuments("  "s);
-
-        for (int i = 0; i < 4; i++) {
-            bool flag = abs(relevance[i] - found_docs[i].relevance) < PRECISION;
-            ASSERT(flag);
-        }
-    }
-
-}
-//   
-void TestComputeRating() {
-    const vector<int> doc_ids = { 0,1,2,3 };
-    const vector<string> contents = {
-        "    "s,
-        "   "s,
-        "   ",
-        "  "s,
-    };
-
-    const vector<DocumentStatus> status = {
-        DocumentStatus::ACTUAL,
-        DocumentStatus::ACTUAL,
-        DocumentStatus::ACTUAL,
-        DocumentStatus::BANNED,
-    };
-
-    const vector<vector<int>> ratings = {
-        {8, -3},
-        {7, 2, 7},
-        {5, -12, 2, 1},
-        {9},
-    };
-
-    const vector<int> result_ratings = { 5, 9, 2,-1 };
-
-    {
-        SearchServer server;
-        server.SetStopWords("  "s);
-        for (int i = 0; i < 4; i++) {
-            server.AddDocument(doc_ids[i], contents[i], DocumentStatus::ACTUAL, ratings[i]);
-        }
-
-        const auto found_docs = server.FindTopDocuments("  "s, DocumentStatus::ACTUAL);
-
-        for (int i = 0; i < 4; i++) {
-            ASSERT_EQUAL(found_docs[i].rating, result_ratings[i]);
-        }
-
-    }
-}
-// ,   
-void TestFindDocumentByStatus() {
-    const vector<int> doc_ids = { 1,2,3,4,5 };
-    const vector<string> contents = {
-        "cat in the town"s,
-        "cat in the city"s,
-        "cat eats a fish"s,
-        "cat like a fish"s,
-        "funny cat"
-    };
-    const vector<vector<int>> ratings = {
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-    };
-    const vector<DocumentStatus> status = {
-        DocumentStatus::ACTUAL,
-        DocumentStatus::ACTUAL,
-        DocumentStatus::ACTUAL,
-        DocumentStatus::BANNED,
-        DocumentStatus::IRRELEVANT,
-    };
-
-    {
-        SearchServer server;
-
-        for (int i = 0; i < 5; i++) {
-            server.AddDocument(doc_ids[i], contents[i], status[i], ratings[i]);
-        }
-
-        const auto actual_doc = server.FindTopDocuments("cat"s, DocumentStatus::ACTUAL);
-        const auto irrelevant_doc = server.FindTopDocuments("cat"s, DocumentStatus::IRRELEVANT);
-        const auto banned_doc = server.FindTopDocuments("cat"s, DocumentStatus::BANNED);
-        const auto removed_doc = server.FindTopDocuments("cat"s, DocumentStatus::REMOVED);
-
-        ASSERT_EQUAL(actual_doc.size(), 3u);
-        ASSERT_EQUAL(irrelevant_doc.size(), 1u);
-        ASSERT_EQUAL(banned_doc.size(), 1u);
-        ASSERT_EQUAL(removed_doc.size(), 0u);
-    }
-}
-//  MatchDocument
-void TestMatchDocument() {
-    const vector<int> doc_ids = { 1,2,3,4,5 };
-    const vector<string> contents = {
-        "cat in the town"s,
-        "cat in the city"s,
-        "cat eats a fish"s,
-        "cat like a fish"s,
-        "funny cat"
-    };
-    const vector<vector<int>> ratings = {
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-        { 1, 2, 3 },
-    };
-    const vector<DocumentStatus> status = {
-        DocumentStatus::ACTUAL,
-        DocumentStatus::ACTUAL,
-        DocumentStatus::ACTUAL,
-        DocumentStatus::BANNED,
-        DocumentStatus::IRRELEVANT,
-    };
-
-    {
-        SearchServer server;
-        for (int i = 0; i < 5; i++) {
-            server.AddDocument(doc_ids[i], contents[i], status[i], ratings[i]);
-        }
-
-        const tuple<vector<string>, DocumentStatus> first_test = server.MatchDocument("cat -town"s, 1);
-        const tuple<vector<string>, DocumentStatus> second_test = server.MatchDocument("cat"s, 1);
-        const tuple<vector<string>, DocumentStatus> third_test = server.MatchDocument("cat -town"s, 4);
-        const tuple<vector<string>, DocumentStatus> forth_test = server.MatchDocument("cat -fish"s, 4);
-
-        ASSERT_EQUAL(get<0>(first_test).size(), 0u);
-        ASSERT_EQUAL(static_cast<int>(get<1>(first_test)), 0);
-        ASSERT_EQUAL(get<0>(second_test).size(), 1u);
-        ASSERT_EQUAL(static_cast<int>(get<1>(second_test)), 0);
-        ASSERT_EQUAL(get<0>(third_test).size(), 1u);
-        ASSERT_EQUAL(static_cast<int>(get<1>(third_test)), 2);
-        ASSERT_EQUAL(get<0>(forth_test).size(), 0u);
-        ASSERT_EQUAL(static_cast<int>(get<1>(forth_test)), 2);
-    }
-}
-
-void TestSearchServer() {
-    RUN_TEST(TestExcludeStopWordsFromAddedDocumentContent);
-    RUN_TEST(TestFindDocumentsWithMinusWords);
-    RUN_TEST(TestAddDocuments);
-    RUN_TEST(TestGetDocumentCount);
-    RUN_TEST(TestComputeRelevance);
-    RUN_TEST(TestFindDocumentByStatus);
-    RUN_TEST(TestComputeRating);
-    RUN_TEST(TestMatchDocument);
-}
-*/
-
-template <typename T, typename U>
-void AssertEqualImpl(const T& t, const U& u, const std::string& t_str, const std::string& u_str, const std::string& file,
-    const std::string& func, unsigned line, const std::string& hint) {
-    if (t != u) {
-        using namespace std;
-        cerr << boolalpha;
-        cerr << file << "("s << line << "): "s << func << ": "s;
-        cerr << "ASSERT_EQUAL("s << t_str << ", "s << u_str << ") failed: "s;
-        cerr << t << " != "s << u << "."s;
-        if (!hint.empty()) {
-            cerr << " Hint: "s << hint;
-        }
-        cerr << endl;
-        abort();
-    }
-}
-
-template <typename TestFunc>
-void RunTestImpl(const TestFunc& func, const std::string& test_name) {
-    func();
-    using namespace std;
-    cerr << test_name << " OK"s << endl;
+#pragma once
+
+#include "async_search.h"
+#include "cached_search_server.h"
+#include "cancellation.h"
+#include "compressed_posting_list.h"
+#include "concurrent_search_server.h"
+#include "document.h"
+#include "document_bitmap.h"
+#include "instrumented_search_server.h"
+#include "inverted_index.h"
+#include "process_queries.h"
+#include "relevance_accumulator.h"
+#include "request_queue.h"
+#include "search_server.h"
+#include "segmented_search_server.h"
+#include "sharded_search_server.h"
+#include "snapshot.h"
+#include "string_processing.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <execution>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/*
+    
+   ASSERT, ASSERT_EQUAL, ASSERT_EQUAL_HINT, ASSERT_HINT  RUN_TEST
+*/
+
+void AssertImpl(bool value, const std::string& expr_str, const std::string& file, const std::string& func, unsigned line,
+    const std::string& hint);
+
+template <typename T, typename U>
+void AssertEqualImpl(const T& t, const U& u, const std::string& t_str, const std::string& u_str, const std::string& file, const std::string& func, unsigned line, const std::string& hint);
+
+template <typename TestFunc>
+void RunTestImpl(const TestFunc& func, const std::string& test_name);
+
+#define ASSERT(a) AssertImpl(a,#a, __FILE__, __FUNCTION__, __LINE__, ""s)
+#define ASSERT_HINT(a, hint) AssertImpl(a,#a, __FILE__, __FUNCTION__, __LINE__, (hint))
+#define ASSERT_EQUAL(a, b) AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, ""s)
+#define ASSERT_EQUAL_HINT(a, b, hint) AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, (hint))
+#define RUN_TEST(func) RunTestImpl(func, #func)
+
+// --------      ----------
+/*
+//  ,     -   
+void TestExcludeStopWordsFromAddedDocumentContent() {
+    const int doc_id = 42;
+    const string content = "cat in the city"s;
+    const vector<int> ratings = { 1, 2, 3 };
+    {
+        SearchServer server;
+        server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
+        const auto found_docs = server.FindTopDocuments("in"s);
+        ASSERT_EQUAL(found_docs.size(), 1u);
+        const Document& doc0 = found_docs[0];
+        ASSERT_EQUAL(doc0.id, doc_id);
+    }
+
+    {
+        SearchServer server;
+        server.SetStopWords("in the"s);
+        server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
+        ASSERT_HINT(server.FindTopDocuments("in"s).empty(),
+            "Stop words must be excluded from documents"s);
+    }
+}
+//  -
+void TestFindDocumentsWithMinusWords() {
+    const int doc_id_1 = 10;
+    const string content_1 = "cat in the town"s;
+    const vector<int> ratings_1 = { 1, 2, 3 };
+
+    const int doc_id_2 = 11;
+    const string content_2 = "cat in the city"s;
+    const vector<int> ratings_2 = { 1, 2, 3 };
+
+    {
+        SearchServer server;
+        server.AddDocument(doc_id_1, content_1, DocumentStatus::ACTUAL, ratings_1);
+        server.AddDocument(doc_id_2, content_2, DocumentStatus::ACTUAL, ratings_2);
+
+        const auto found_docs = server.FindTopDocuments("cat -city"s);
+        ASSERT_EQUAL(found_docs[0].id, 10);
+        ASSERT_EQUAL(found_docs.size(), 1u);
+    }
+
+    {
+        SearchServer server;
+        server.AddDocument(doc_id_1, content_1, DocumentStatus::ACTUAL, ratings_1);
+        server.AddDocument(doc_id_2, content_2, DocumentStatus::ACTUAL, ratings_2);
+
+        const auto found_docs = server.FindTopDocuments("-cat city"s);
+        ASSERT_EQUAL(found_docs.size(), 0u);
+    }
+}
+//  
+void TestAddDocuments() {
+    const vector<int> doc_ids = { 1,2,3,4,5 };
+    const vector<string> contents = {
+        "cat in the town"s,
+        "cat in the city"s,
+        "cat eats a fish"s,
+        "cat like a fish"s,
+        "funny cat"
+    };
+    const vector<vector<int>> ratings = {
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+    };
+
+    {
+        SearchServer server;
+        for (int i = 0; i < 5; i++) {
+            server.AddDocument(doc_ids[i], contents[i], DocumentStatus::ACTUAL, ratings[i]);
+        }
+
+        const auto found_docs = server.FindTopDocuments("cat"s);
+
+        ASSERT_EQUAL(found_docs.size(), 5u);
+        for (int i = 0; i < 5; i++) {
+            ASSERT_EQUAL(found_docs[i].id, doc_ids[i]);
+        }
+    }
+}
+//  - 
+void TestGetDocumentCount() {
+    const vector<int> doc_ids = { 1,2,3,4,5 };
+    const vector<string> contents = {
+        "cat in the town"s,
+        "cat in the city"s,
+        "cat eats a fish"s,
+        "cat like a fish"s,
+        "funny cat"
+    };
+    const vector<vector<int>> ratings = {
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+    };
+
+    {
+        SearchServer server;
+        for (int i = 0; i < 5; i++) {
+            server.AddDocument(doc_ids[i], contents[i], DocumentStatus::ACTUAL, ratings[i]);
+        }
+
+        ASSERT_EQUAL(server.GetDocumentCount(), 5);
+    }
+}
+//   
+void TestComputeRelevance() {
+
+    const vector<int> doc_ids = { 0,1,2,3 };
+    const vector<string> contents = {
+        "    "s,
+        "   "s,
+        "   ",
+        "  "s,
+    };
+
+    const vector<vector<int>> ratings = {
+        {8, -3},
+        {7, 2, 7},
+        {5, -12, 2, 1},
+        {9},
+    };
+
+    const vector<double> relevance = { 0.866434, 0.231049, 0.173287, 0.173287 };
+
+    {
+        SearchServer server;
+        server.SetStopWords("  "s);
+        for (int i = 0; i < 4; i++) {
+            server.AddDocument(doc_ids[i], contents[i], DocumentStatus::ACTUAL, ratings[i]);
+        }
+
+        const auto found_docs = server.FindTopDocuments("  "s);
+
+        for (int i = 0; i < 4; i++) {
+            bool flag = abs(relevance[i] - found_docs[i].relevance) < PRECISION;
+            ASSERT(flag);
+        }
+    }
+
+}
+//   
+void TestComputeRating() {
+    const vector<int> doc_ids = { 0,1,2,3 };
+    const vector<string> contents = {
+        "    "s,
+        "   "s,
+        "   ",
+        "  "s,
+    };
+
+    const vector<DocumentStatus> status = {
+        DocumentStatus::ACTUAL,
+        DocumentStatus::ACTUAL,
+        DocumentStatus::ACTUAL,
+        DocumentStatus::BANNED,
+    };
+
+    const vector<vector<int>> ratings = {
+        {8, -3},
+        {7, 2, 7},
+        {5, -12, 2, 1},
+        {9},
+    };
+
+    const vector<int> result_ratings = { 5, 9, 2,-1 };
+
+    {
+        SearchServer server;
+        server.SetStopWords("  "s);
+        for (int i = 0; i < 4; i++) {
+            server.AddDocument(doc_ids[i], contents[i], DocumentStatus::ACTUAL, ratings[i]);
+        }
+
+        const auto found_docs = server.FindTopDocuments("  "s, DocumentStatus::ACTUAL);
+
+        for (int i = 0; i < 4; i++) {
+            ASSERT_EQUAL(found_docs[i].rating, result_ratings[i]);
+        }
+
+    }
+}
+// ,   
+void TestFindDocumentByStatus() {
+    const vector<int> doc_ids = { 1,2,3,4,5 };
+    const vector<string> contents = {
+        "cat in the town"s,
+        "cat in the city"s,
+        "cat eats a fish"s,
+        "cat like a fish"s,
+        "funny cat"
+    };
+    const vector<vector<int>> ratings = {
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+    };
+    const vector<DocumentStatus> status = {
+        DocumentStatus::ACTUAL,
+        DocumentStatus::ACTUAL,
+        DocumentStatus::ACTUAL,
+        DocumentStatus::BANNED,
+        DocumentStatus::IRRELEVANT,
+    };
+
+    {
+        SearchServer server;
+
+        for (int i = 0; i < 5; i++) {
+            server.AddDocument(doc_ids[i], contents[i], status[i], ratings[i]);
+        }
+
+        const auto actual_doc = server.FindTopDocuments("cat"s, DocumentStatus::ACTUAL);
+        const auto irrelevant_doc = server.FindTopDocuments("cat"s, DocumentStatus::IRRELEVANT);
+        const auto banned_doc = server.FindTopDocuments("cat"s, DocumentStatus::BANNED);
+        const auto removed_doc = server.FindTopDocuments("cat"s, DocumentStatus::REMOVED);
+
+        ASSERT_EQUAL(actual_doc.size(), 3u);
+        ASSERT_EQUAL(irrelevant_doc.size(), 1u);
+        ASSERT_EQUAL(banned_doc.size(), 1u);
+        ASSERT_EQUAL(removed_doc.size(), 0u);
+    }
+}
+//  MatchDocument
+void TestMatchDocument() {
+    const vector<int> doc_ids = { 1,2,3,4,5 };
+    const vector<string> contents = {
+        "cat in the town"s,
+        "cat in the city"s,
+        "cat eats a fish"s,
+        "cat like a fish"s,
+        "funny cat"
+    };
+    const vector<vector<int>> ratings = {
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+        { 1, 2, 3 },
+    };
+    const vector<DocumentStatus> status = {
+        DocumentStatus::ACTUAL,
+        DocumentStatus::ACTUAL,
+        DocumentStatus::ACTUAL,
+        DocumentStatus::BANNED,
+        DocumentStatus::IRRELEVANT,
+    };
+
+    {
+        SearchServer server;
+        for (int i = 0; i < 5; i++) {
+            server.AddDocument(doc_ids[i], contents[i], status[i], ratings[i]);
+        }
+
+        const tuple<vector<string>, DocumentStatus> first_test = server.MatchDocument("cat -town"s, 1);
+        const tuple<vector<string>, DocumentStatus> second_test = server.MatchDocument("cat"s, 1);
+        const tuple<vector<string>, DocumentStatus> third_test = server.MatchDocument("cat -town"s, 4);
+        const tuple<vector<string>, DocumentStatus> forth_test = server.MatchDocument("cat -fish"s, 4);
+
+        ASSERT_EQUAL(get<0>(first_test).size(), 0u);
+        ASSERT_EQUAL(static_cast<int>(get<1>(first_test)), 0);
+        ASSERT_EQUAL(get<0>(second_test).size(), 1u);
+        ASSERT_EQUAL(static_cast<int>(get<1>(second_test)), 0);
+        ASSERT_EQUAL(get<0>(third_test).size(), 1u);
+        ASSERT_EQUAL(static_cast<int>(get<1>(third_test)), 2);
+        ASSERT_EQUAL(get<0>(forth_test).size(), 0u);
+        ASSERT_EQUAL(static_cast<int>(get<1>(forth_test)), 2);
+    }
+}
+
+void TestSearchServer() {
+    RUN_TEST(TestExcludeStopWordsFromAddedDocumentContent);
+    RUN_TEST(TestFindDocumentsWithMinusWords);
+    RUN_TEST(TestAddDocuments);
+    RUN_TEST(TestGetDocumentCount);
+    RUN_TEST(TestComputeRelevance);
+    RUN_TEST(TestFindDocumentByStatus);
+    RUN_TEST(TestComputeRating);
+    RUN_TEST(TestMatchDocument);
+}
+*/
+
+// --------  :     SearchServer ----------
+
+inline std::string MakeRandomText(std::mt19937& generator, int word_count, int dictionary_size) {
+    using namespace std;
+    string text;
+    for (int i = 0; i < word_count; ++i) {
+        text += "w"s + to_string(generator() % dictionary_size) + " "s;
+    }
+    return text;
+}
+
+//     - -
+inline std::string MakeRandomQuery(std::mt19937& generator, int word_count, int dictionary_size) {
+    using namespace std;
+    string query;
+    for (int i = 0; i < word_count; ++i) {
+        if (generator() % 4 == 0) {
+            query += "-"s;
+        }
+        query += "w"s + to_string(generator() % dictionary_size) + " "s;
+    }
+    return query;
+}
+
+inline void AssertEqualDocuments(const std::vector<Document>& found_docs, const std::vector<Document>& expected_docs,
+    const std::string& hint) {
+    ASSERT_EQUAL_HINT(found_docs.size(), expected_docs.size(), hint);
+    for (size_t i = 0; i < found_docs.size(); ++i) {
+        ASSERT_EQUAL_HINT(found_docs[i].id, expected_docs[i].id, hint);
+        ASSERT_EQUAL_HINT(found_docs[i].relevance, expected_docs[i].relevance, hint);
+        ASSERT_EQUAL_HINT(found_docs[i].rating, expected_docs[i].rating, hint);
+    }
+}
+
+//    ,   SearchServer,  ,    
+inline void TestSegmentedSearchServerMatchesSearchServer() {
+    using namespace std;
+    mt19937 generator(16);
+    SegmentedSearchServer segmented_server("w0 w1"s, 20);
+    SearchServer server("w0 w1"s);
+    const auto predicate = [](int document_id, DocumentStatus status, int rating) {
+        return document_id % 3 != 0;
+    };
+    vector<int> live_ids;
+    for (int step = 0; step < 3000; ++step) {
+        const int operation = generator() % 10;
+        if (operation < 6) {
+            const int document_id = generator() % 2000;
+            const string document = MakeRandomText(generator, generator() % 10, 100);
+            const DocumentStatus status = static_cast<DocumentStatus>(generator() % 4);
+            const vector<int> ratings = { static_cast<int>(generator() % 20) - 5 };
+            bool is_added_to_segmented = true;
+            bool is_added = true;
+            try {
+                segmented_server.AddDocument(document_id, document, status, ratings);
+            }
+            catch (const invalid_argument&) {
+                is_added_to_segmented = false;
+            }
+            try {
+                server.AddDocument(document_id, document, status, ratings);
+            }
+            catch (const invalid_argument&) {
+                is_added = false;
+            }
+            ASSERT_EQUAL(is_added_to_segmented, is_added);
+            if (is_added) {
+                live_ids.push_back(document_id);
+            }
+        }
+        else if (operation < 8 && !live_ids.empty()) {
+            const size_t index = generator() % live_ids.size();
+            segmented_server.RemoveDocument(live_ids[index]);
+            server.RemoveDocument(live_ids[index]);
+            live_ids.erase(live_ids.begin() + index);
+        }
+        else {
+            const string query = MakeRandomQuery(generator, 3, 100);
+            const size_t max_result_count = 1 + generator() % 20;
+            AssertEqualDocuments(segmented_server.FindTopDocuments(query, predicate, max_result_count),
+                server.FindTopDocuments(query, predicate, max_result_count), query);
+            AssertEqualDocuments(segmented_server.FindTopDocuments(query, DocumentStatus::BANNED, max_result_count),
+                server.FindTopDocuments(query, DocumentStatus::BANNED, max_result_count), query);
+        }
+        if (step % 500 == 499) {
+            segmented_server.WaitForMerges();
+        }
+        ASSERT_EQUAL(segmented_server.GetDocumentCount(), server.GetDocumentCount());
+    }
+
+    segmented_server.Flush();
+    segmented_server.WaitForMerges();
+    //     
+    ASSERT(segmented_server.GetSegmentCount() < static_cast<size_t>(server.GetDocumentCount()) / 20);
+    for (int word = 0; word < 100; ++word) {
+        const string query = "w"s + to_string(word) + " -w7"s;
+        AssertEqualDocuments(segmented_server.FindTopDocuments(query), server.FindTopDocuments(query), query);
+    }
+}
+
+//      (MaxScore)   ,    
+inline void TestMaxScoreMatchesExhaustiveSearch() {
+    using namespace std;
+    mt19937 generator(9);
+    for (int round = 0; round < 4; ++round) {
+        const int dictionary_size = 5 + round * 40;
+        SearchServer server("w1"s);
+        //      
+        map<int, pair<DocumentStatus, int>> documents;
+        for (int document_id = 0; document_id < 300 + round * 600; ++document_id) {
+            string document;
+            for (int i = 0, word_count = 1 + generator() % (round + 3); i < word_count; ++i) {
+                //        
+                document += "w"s + to_string(min(generator() % dictionary_size, generator() % dictionary_size)) + " "s;
+            }
+            const DocumentStatus status = static_cast<DocumentStatus>(generator() % 3);
+            const int rating = generator() % 3;
+            server.AddDocument(document_id, document, status, { rating });
+            documents[document_id] = { status, rating };
+        }
+        for (int document_id = 0; document_id < static_cast<int>(documents.size()); document_id += 7) {
+            server.RemoveDocument(document_id);
+            documents.erase(document_id);
+        }
+        const double log_document_count = log(static_cast<double>(documents.size()));
+
+        for (int query_index = 0; query_index < 200; ++query_index) {
+            const string query = MakeRandomQuery(generator, 1 + generator() % 6, dictionary_size);
+            const size_t max_result_count = generator() % 12;
+            const DocumentStatus status = static_cast<DocumentStatus>(generator() % 3);
+
+            set<string> plus_words;
+            set<string> minus_words;
+            for (const string_view word : SplitIntoWords(query)) {
+                if (word[0] == '-') {
+                    minus_words.insert(string(word.substr(1)));
+                }
+                else if (word != "w1"sv) {
+                    plus_words.insert(string(word));
+                }
+            }
+            //       ,   
+            vector<Document> expected_docs;
+            for (const auto& [document_id, status_and_rating] : documents) {
+                const map<string_view, double>& word_freqs = server.GetWordFrequencies(document_id);
+                if (status_and_rating.first != status || any_of(minus_words.begin(), minus_words.end(),
+                    [&word_freqs](const string& word) {
+                        return word_freqs.count(word) > 0;
+                    })) {
+                    continue;
+                }
+                double relevance = 0.0;
+                bool is_matched = false;
+                for (const string& word : plus_words) {
+                    if (const auto it = word_freqs.find(word); it != word_freqs.end()) {
+                        relevance += it->second
+                            * (log_document_count - log(static_cast<double>(server.GetDocumentFreq(word))));
+                        is_matched = true;
+                    }
+                }
+                if (is_matched) {
+                    expected_docs.push_back({ document_id, relevance, status_and_rating.second });
+                }
+            }
+            sort(expected_docs.begin(), expected_docs.end(), IsMoreRelevant);
+            expected_docs.resize(min(expected_docs.size(), max_result_count));
+
+            AssertEqualDocuments(server.FindTopDocuments(query, status, max_result_count), expected_docs, query);
+            const auto predicate = [status](int document_id, DocumentStatus document_status, int rating) {
+                return document_status == status;
+            };
+            AssertEqualDocuments(server.FindTopDocuments(query, predicate, max_result_count), expected_docs, query);
+            AssertEqualDocuments(server.FindTopDocuments(execution::par, query, predicate, max_result_count),
+                expected_docs, query);
+        }
+    }
+}
+
+//        ,      
+inline void TestFindDocumentsByStatusPartition() {
+    using namespace std;
+    SearchServer server("and"s);
+    for (int document_id = 0; document_id < 1000; ++document_id) {
+        const DocumentStatus status = document_id % 10 == 0 ? DocumentStatus::ACTUAL : DocumentStatus::BANNED;
+        server.AddDocument(document_id, document_id % 2 == 0 ? "cat and city"s : "cat"s, status, { document_id % 7 });
+    }
+    server.RemoveDocument(5);
+    server.AddDocument(5, "cat"s, DocumentStatus::ACTUAL, { 1 });
+    ASSERT_EQUAL(static_cast<int>(get<1>(server.MatchDocument("cat"s, 5))), static_cast<int>(DocumentStatus::ACTUAL));
+
+    for (int status = 0; status < 4; ++status) {
+        const DocumentStatus document_status = static_cast<DocumentStatus>(status);
+        const auto predicate = [document_status](int document_id, DocumentStatus status, int rating) {
+            return status == document_status;
+        };
+        for (const string& query : { "cat"s, "city"s, "cat -city"s }) {
+            const vector<Document> found_docs = server.FindTopDocuments(query, document_status, 1000);
+            AssertEqualDocuments(found_docs, server.FindTopDocuments(query, predicate, 1000), query);
+            AssertEqualDocuments(server.FindTopDocuments(execution::par, query, document_status, 1000), found_docs,
+                query);
+        }
+    }
+    ASSERT_EQUAL(server.FindTopDocuments("cat"s, DocumentStatus::ACTUAL, 1000).size(), 101u);
+    ASSERT_EQUAL(server.FindTopDocuments("cat"s, DocumentStatus::BANNED, 1000).size(), 899u);
+    ASSERT(server.FindTopDocuments("cat"s, DocumentStatus::REMOVED).empty());
+
+    //  BANNED       
+    const QueryTrace trace = server.Explain("cat"s, DocumentStatus::ACTUAL);
+    ASSERT(trace.GetCounter(QueryCounter::POSTINGS_VISITED) <= 101u);
+}
+
+//     :    , 
+inline void TestDocumentBitmap() {
+    using namespace std;
+    mt19937 generator(12);
+    for (int round = 0; round < 20; ++round) {
+        set<int> expected_documents;
+        DocumentBitmap bitmap;
+        for (int list = 0; list < 1 + round % 4; ++list) {
+            const int range = 1 + generator() % 300000;
+            vector<int> documents;
+            for (int i = 0, count = generator() % (round % 2 == 0 ? 300 : 20000); i < count; ++i) {
+                documents.push_back(generator() % range);
+            }
+            sort(documents.begin(), documents.end());
+            documents.erase(unique(documents.begin(), documents.end()), documents.end());
+            expected_documents.insert(documents.begin(), documents.end());
+            bitmap.UnionWith(DocumentBitmap(documents));
+        }
+        for (int document = 0; document < 300000; document += 7) {
+            ASSERT_EQUAL(bitmap.Contains(document), expected_documents.count(document) > 0);
+        }
+    }
+}
+
+//-    ,       
+inline void TestExcludeMinusWordsWithBitmap() {
+    using namespace std;
+    SearchServer server("and"s);
+    //        65536 
+    for (int document_id = 0; document_id < 70000; ++document_id) {
+        string document = "cat"s;
+        if (document_id % 3 == 0) {
+            document += " dog"s;
+        }
+        if (document_id % 1000 == 1) {
+            document += " bird"s;
+        }
+        server.AddDocument(document_id, document, DocumentStatus::ACTUAL, { 1 });
+    }
+
+    const vector<Document> without_dogs = server.FindTopDocuments("cat -dog"s, DocumentStatus::ACTUAL, 70000);
+    ASSERT_EQUAL(without_dogs.size(), 46666u);
+    for (const Document& document : without_dogs) {
+        ASSERT(document.id % 3 != 0);
+    }
+    const vector<Document> without_birds = server.FindTopDocuments(execution::par, "cat -bird -fish"s,
+        DocumentStatus::ACTUAL, 70000);
+    ASSERT_EQUAL(without_birds.size(), 69930u);
+    for (const Document& document : without_birds) {
+        ASSERT(document.id % 1000 != 1);
+    }
+    ASSERT(server.FindTopDocuments("dog -cat"s).empty());
+}
+
+//      ,   SearchServer,    -
+inline void TestShardedSearchServerMatchesSearchServer() {
+    using namespace std;
+    mt19937 generator(17);
+    ShardedSearchServer sharded_server("w0 w1"s, 5);
+    SearchServer server("w0 w1"s);
+    const auto predicate = [](int document_id, DocumentStatus status, int rating) {
+        return document_id % 3 != 0;
+    };
+    vector<int> live_ids;
+    for (int step = 0; step < 3000; ++step) {
+        const int operation = generator() % 10;
+        if (operation < 6) {
+            //      
+            const int document_id = static_cast<int>(generator() % 2000) - 3;
+            const string document = MakeRandomText(generator, generator() % 10, 100);
+            const DocumentStatus status = static_cast<DocumentStatus>(generator() % 4);
+            const vector<int> ratings = { static_cast<int>(generator() % 20) - 5 };
+            bool is_added_to_sharded = true;
+            bool is_added = true;
+            try {
+                sharded_server.AddDocument(document_id, document, status, ratings);
+            }
+            catch (const invalid_argument&) {
+                is_added_to_sharded = false;
+            }
+            try {
+                server.AddDocument(document_id, document, status, ratings);
+            }
+            catch (const invalid_argument&) {
+                is_added = false;
+            }
+            ASSERT_EQUAL(is_added_to_sharded, is_added);
+            if (is_added) {
+                live_ids.push_back(document_id);
+            }
+        }
+        else if (operation < 8 && !live_ids.empty()) {
+            const size_t index = generator() % live_ids.size();
+            sharded_server.RemoveDocument(live_ids[index]);
+            server.RemoveDocument(live_ids[index]);
+            live_ids.erase(live_ids.begin() + index);
+            if (index % 8 == 0) {
+                sharded_server.Compact();
+            }
+        }
+        else {
+            const string query = MakeRandomQuery(generator, 3, 100);
+            const size_t max_result_count = 1 + generator() % 20;
+            AssertEqualDocuments(sharded_server.FindTopDocuments(query, predicate, max_result_count),
+                server.FindTopDocuments(query, predicate, max_result_count), query);
+            AssertEqualDocuments(sharded_server.FindTopDocuments(query), server.FindTopDocuments(query), query);
+            if (!live_ids.empty()) {
+                const int document_id = live_ids[generator() % live_ids.size()];
+                ASSERT(sharded_server.MatchDocument(query, document_id) == server.MatchDocument(query, document_id));
+            }
+        }
+        ASSERT_EQUAL(sharded_server.GetDocumentCount(), server.GetDocumentCount());
+    }
+}
+
+//           
+inline void TestCancelSearch() {
+    using namespace std;
+    SearchServer server("and"s);
+    for (int document_id = 0; document_id < 20000; ++document_id) {
+        server.AddDocument(document_id, document_id % 2 == 0 ? "cat and dog"s : "cat"s,
+            document_id % 5 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL, { document_id % 10 });
+    }
+    ThreadPool thread_pool(4);
+
+    {
+        CancellationSource cancellation_source;
+        cancellation_source.Cancel();
+        bool is_cancelled = false;
+        try {
+            FindTopDocumentsAsync(thread_pool, server, "cat"s, DocumentStatus::ACTUAL, 5,
+                cancellation_source.GetToken()).get();
+        }
+        catch (const OperationCancelled&) {
+            is_cancelled = true;
+        }
+        ASSERT(is_cancelled);
+    }
+
+    //      ;       
+    {
+        CancellationSource cancellation_source;
+        atomic<int> predicate_call_count = 0;
+        const auto cancelling_predicate = [&](int document_id, DocumentStatus status, int rating) {
+            ++predicate_call_count;
+            cancellation_source.Cancel();
+            return true;
+        };
+        bool is_cancelled = false;
+        try {
+            server.FindTopDocuments(execution::seq, "cat dog"s, cancelling_predicate, 20000,
+                cancellation_source.GetToken());
+        }
+        catch (const OperationCancelled&) {
+            is_cancelled = true;
+        }
+        ASSERT(is_cancelled);
+        ASSERT(predicate_call_count <= static_cast<int>(InvertedIndex::PostingList::BLOCK_SIZE));
+    }
+
+    //       
+    for (int round = 0; round < 10; ++round) {
+        CancellationSource cancellation_source;
+        atomic<int> predicate_call_count = 0;
+        const auto cancelling_predicate = [&](int document_id, DocumentStatus status, int rating) {
+            ++predicate_call_count;
+            cancellation_source.Cancel();
+            return true;
+        };
+        bool is_cancelled = false;
+        try {
+            FindTopDocumentsAsync(thread_pool, server, "cat dog"s, cancelling_predicate, 20000,
+                cancellation_source.GetToken(), 0).get();
+        }
+        catch (const OperationCancelled&) {
+            is_cancelled = true;
+        }
+        ASSERT(is_cancelled);
+        //         30000 
+        ASSERT(predicate_call_count < 2000);
+    }
+
+    //      
+    const auto any_status = [](int document_id, DocumentStatus status, int rating) {
+        return true;
+    };
+    AssertEqualDocuments(FindTopDocumentsAsync(thread_pool, server, "cat dog"s, any_status, 100, {}, 0).get(),
+        server.FindTopDocuments("cat dog"s, any_status, 100), "cat dog"s);
+    for (const DocumentStatus status : { DocumentStatus::ACTUAL, DocumentStatus::BANNED }) {
+        AssertEqualDocuments(FindTopDocumentsAsync(thread_pool, server, "cat -dog"s, status, 100, {}, 0).get(),
+            server.FindTopDocuments("cat -dog"s, status, 100), "cat -dog"s);
+        AssertEqualDocuments(FindTopDocumentsAsync(thread_pool, server, "dog"s, status, 100).get(),
+            server.FindTopDocuments("dog"s, status, 100), "dog"s);
+    }
+}
+
+//  ,      ,     
+inline void TestSnapshotSaveAndValidation() {
+    using namespace std;
+    const string path = (filesystem::temp_directory_path() / "search_server_module_tests.snapshot"s).string();
+    {
+        SearchServer server("and"s);
+        server.AddDocument(1, "cat and dog"s, DocumentStatus::ACTUAL, { 1 });
+        server.SaveSnapshot(path);
+        server.AddDocument(2, "bird"s, DocumentStatus::BANNED, { 2 });
+        server.SaveSnapshot(path);
+        const SearchServer loaded_server = SearchServer::LoadSnapshot(path);
+        ASSERT_EQUAL(loaded_server.GetDocumentCount(), 2);
+        AssertEqualDocuments(loaded_server.FindTopDocuments("bird"s, DocumentStatus::BANNED),
+            server.FindTopDocuments("bird"s, DocumentStatus::BANNED), "bird"s);
+        ASSERT(!filesystem::exists(path + ".tmp"s));
+    }
+
+    //    id 1   ,      ACTUAL
+    const auto save_snapshot = [&path](int status, int posting_document, double block_max_term_freq = 1.0,
+        double max_term_freq = 1.0) {
+        SnapshotWriter writer;
+        writer.Write<uint64_t>(0);
+        writer.Write<uint64_t>(1);
+        writer.Write<int>(1);
+        writer.Write<int>(0);
+        writer.Write<int>(status);
+        writer.WriteArray(vector<int>{ 1 });
+        writer.Write<uint64_t>(1);
+        writer.WriteString("cat"sv);
+        for (size_t partition = 0; partition < InvertedIndex::STATUS_COUNT; ++partition) {
+            const vector<int> documents = partition == 0 ? vector<int>{ posting_document } : vector<int>{};
+            writer.WriteArray(documents);
+            writer.WriteArray(vector<double>(documents.size(), 1.0));
+            writer.WriteArray(vector<double>(documents.size(), block_max_term_freq));
+            writer.Write(documents.empty() ? 0.0 : max_term_freq);
+        }
+        writer.SaveToFile(path);
+    };
+    const auto is_loaded = [&path] {
+        try {
+            SearchServer::LoadSnapshot(path);
+        }
+        catch (const runtime_error&) {
+            return false;
+        }
+        return true;
+    };
+    save_snapshot(0, 0);
+    ASSERT(is_loaded());
+    save_snapshot(0, 5);
+    ASSERT_HINT(!is_loaded(), "Postings must address known documents"s);
+    save_snapshot(0, -1);
+    ASSERT(!is_loaded());
+    save_snapshot(7, 0);
+    ASSERT_HINT(!is_loaded(), "Document status must be in range"s);
+    save_snapshot(0, 0, 0.5);
+    ASSERT_HINT(!is_loaded(), "Block maxima must match the term frequencies"s);
+    save_snapshot(0, 0, 1.0, 0.5);
+    ASSERT_HINT(!is_loaded(), "The list maximum must match the block maxima"s);
+    filesystem::remove(path);
+}
+
+//              
+inline void TestCachedSearchServerAfterAssignment() {
+    using namespace std;
+    SearchServer server("and"s);
+    server.AddDocument(1, "cat and dog"s, DocumentStatus::ACTUAL, { 1 });
+    const CachedSearchServer cached_server(server);
+    ASSERT_EQUAL(cached_server.FindTopDocuments("cat"s).size(), 1u);
+    ASSERT_EQUAL(cached_server.FindTopDocuments("cat"s).size(), 1u);
+    ASSERT_EQUAL(cached_server.GetHitCount(), 1u);
+
+    SearchServer other_server("and"s);
+    other_server.AddDocument(2, "bird"s, DocumentStatus::ACTUAL, { 1 });
+    ASSERT(other_server.GetGeneration() != server.GetGeneration());
+    server = other_server;
+    ASSERT(cached_server.FindTopDocuments("cat"s).empty());
+    ASSERT_EQUAL(cached_server.FindTopDocuments("bird"s).size(), 1u);
+}
+
+//         
+inline void TestPreparedQueryOwnership() {
+    using namespace std;
+    SearchServer server("and"s);
+    server.AddDocument(1, "cat and dog"s, DocumentStatus::ACTUAL, { 1 });
+    const PreparedQuery cat_query = server.Prepare("cat -fish"s);
+    const PreparedQuery dog_query = server.Prepare("dog"s);
+
+    SearchServer server_copy = server;
+    server_copy.AddDocument(2, "cat fish"s, DocumentStatus::ACTUAL, { 2 });
+    AssertEqualDocuments(server_copy.FindTopDocuments(cat_query), server_copy.FindTopDocuments("cat -fish"s),
+        "cat -fish"s);
+
+    //   cat      bird,    dog   
+    SearchServer other_server("and"s);
+    other_server.AddDocument(1, "bird"s, DocumentStatus::ACTUAL, { 1 });
+    for (const PreparedQuery* query : { &cat_query, &dog_query }) {
+        bool is_rejected = false;
+        try {
+            other_server.FindTopDocuments(*query);
+        }
+        catch (const invalid_argument&) {
+            is_rejected = true;
+        }
+        ASSERT(is_rejected);
+    }
+    bool is_rejected = false;
+    try {
+        other_server.MatchDocument(cat_query, 1);
+    }
+    catch (const invalid_argument&) {
+        is_rejected = true;
+    }
+    ASSERT(is_rejected);
+}
+
+//             
+inline void TestProcessQueriesJoined() {
+    using namespace std;
+    mt19937 generator(2);
+    SearchServer server("w0"s);
+    for (int document_id = 0; document_id < 500; ++document_id) {
+        server.AddDocument(document_id, MakeRandomText(generator, 1 + generator() % 8, 60), DocumentStatus::ACTUAL,
+            { document_id % 5 });
+    }
+    vector<string> queries;
+    for (int i = 0; i < 1000; ++i) {
+        queries.push_back(MakeRandomQuery(generator, 1 + generator() % 3, 80));
+    }
+
+    vector<Document> expected_docs;
+    for (const vector<Document>& documents : ProcessQueries(server, queries)) {
+        expected_docs.insert(expected_docs.end(), documents.begin(), documents.end());
+    }
+    const JoinedDocuments joined_docs = ProcessQueriesJoined(server, queries);
+    AssertEqualDocuments(vector<Document>(joined_docs.begin(), joined_docs.end()), expected_docs, "joined"s);
+    ASSERT_EQUAL(joined_docs.size(), expected_docs.size());
+
+    //       
+    const JoinedDocuments partially_read_docs = ProcessQueriesJoined(server, queries);
+    auto it = partially_read_docs.begin();
+    for (size_t i = 0; i < 10 && it != partially_read_docs.end(); ++i, ++it) {
+        ASSERT_EQUAL(it->id, expected_docs[i].id);
+    }
+    const JoinedDocuments no_docs = ProcessQueriesJoined(server, {});
+    ASSERT(no_docs.begin() == no_docs.end());
+}
+
+//        ,  ,     
+inline void TestRemoveDocumentsMatchesRebuiltServer() {
+    using namespace std;
+    mt19937 generator(6);
+    SearchServer server("w0 w1"s);
+    struct AddedDocument {
+        int id;
+        string text;
+        DocumentStatus status;
+        vector<int> ratings;
+    };
+    //   
+    vector<AddedDocument> live_documents;
+    const auto check = [&](const string& hint) {
+        SearchServer rebuilt_server("w0 w1"s);
+        for (const AddedDocument& document : live_documents) {
+            rebuilt_server.AddDocument(document.id, document.text, document.status, document.ratings);
+        }
+        ASSERT_EQUAL_HINT(server.GetDocumentCount(), rebuilt_server.GetDocumentCount(), hint);
+        for (int index = 0; index < server.GetDocumentCount(); ++index) {
+            ASSERT_EQUAL_HINT(server.GetDocumentId(index), live_documents[index].id, hint);
+        }
+        for (int word = 0; word < 60; word += 7) {
+            const string query = "w"s + to_string(word) + " w"s + to_string(word + 1) + " -w"s + to_string(word + 2);
+            ASSERT_EQUAL_HINT(server.GetDocumentFreq("w"s + to_string(word)),
+                rebuilt_server.GetDocumentFreq("w"s + to_string(word)), hint);
+            AssertEqualDocuments(server.FindTopDocuments(query, DocumentStatus::ACTUAL, 10),
+                rebuilt_server.FindTopDocuments(query, DocumentStatus::ACTUAL, 10), hint + query);
+            AssertEqualDocuments(server.FindTopDocuments(execution::par, query, DocumentStatus::ACTUAL, 10),
+                rebuilt_server.FindTopDocuments(query, DocumentStatus::ACTUAL, 10), hint + query);
+            AssertEqualDocuments(server.FindTopDocuments(execution::par, query,
+                [](int document_id, DocumentStatus status, int rating) { return rating > 0; }, 10),
+                rebuilt_server.FindTopDocuments(query,
+                [](int document_id, DocumentStatus status, int rating) { return rating > 0; }, 10), hint + query);
+        }
+        for (const AddedDocument& document : live_documents) {
+            ASSERT_HINT(server.GetWordFrequencies(document.id) == rebuilt_server.GetWordFrequencies(document.id), hint);
+        }
+    };
+
+    for (int step = 0; step < 4000; ++step) {
+        //   ,   ,      
+        const bool is_removing_phase = step / 500 % 2 == 1;
+        if (generator() % 10 < (is_removing_phase ? 3u : 7u)) {
+            const int document_id = generator() % 1000;
+            const AddedDocument document = { document_id, MakeRandomText(generator, 1 + generator() % 8, 60),
+                static_cast<DocumentStatus>(generator() % 2), { static_cast<int>(generator() % 10) - 3 } };
+            try {
+                server.AddDocument(document.id, document.text, document.status, document.ratings);
+                live_documents.push_back(document);
+            }
+            catch (const invalid_argument&) {
+            }
+        }
+        else if (!live_documents.empty()) {
+            const size_t index = generator() % live_documents.size();
+            server.RemoveDocument(live_documents[index].id);
+            live_documents.erase(live_documents.begin() + index);
+        }
+        if (step % 250 == 249) {
+            check("step "s + to_string(step) + ": "s);
+        }
+        //  ,     
+        if (step % 100 == 99 && server.GetRemovedDocumentCount() > server.GetDocumentCount()) {
+            server.Compact();
+        }
+    }
+
+    //     ,      
+    const string path = (filesystem::temp_directory_path() / "search_server_removals.snapshot").string();
+    server.SaveSnapshot(path);
+    server = SearchServer::LoadSnapshot(path);
+    filesystem::remove(path);
+    check("snapshot: "s);
+
+    ASSERT_EQUAL(server.GetDocumentCount(), static_cast<int>(live_documents.size()));
+    try {
+        server.GetDocumentId(server.GetDocumentCount());
+        ASSERT_HINT(false, "out_of_range expected"s);
+    }
+    catch (const out_of_range&) {
+    }
+}
+
+//          ,     
+inline void TestAddDocumentsInParallelMatchesAddDocument() {
+    using namespace std;
+    mt19937 generator(14);
+    SearchServer server("w0 w1"s);
+    SearchServer batch_server("w0 w1"s);
+    vector<string> texts;
+    for (int batch_index = 0; batch_index < 40; ++batch_index) {
+        const size_t batch_size = 1 + generator() % 300;
+        texts.clear();
+        texts.reserve(batch_size);
+        vector<DocumentInput> batch;
+        for (size_t i = 0; i < batch_size; ++i) {
+            string text = MakeRandomText(generator, generator() % 12, 80 + batch_index * 20);
+            //    ,    
+            if (generator() % 500 == 0) {
+                text += "bad\x01word"s;
+            }
+            texts.push_back(move(text));
+            const int document_id = static_cast<int>(generator() % 20000) - 2;
+            batch.push_back({ document_id, texts.back(), static_cast<DocumentStatus>(generator() % 4),
+                { static_cast<int>(generator() % 10) } });
+        }
+
+        string error;
+        for (const DocumentInput& document : batch) {
+            try {
+                server.AddDocument(document.document_id, document.document, document.status, document.ratings);
+            }
+            catch (const invalid_argument& e) {
+                error = e.what();
+                break;
+            }
+        }
+        string batch_error;
+        try {
+            batch_server.AddDocuments(execution::par, batch);
+        }
+        catch (const invalid_argument& e) {
+            batch_error = e.what();
+        }
+        ASSERT_EQUAL(batch_error, error);
+    }
+
+    ASSERT_EQUAL(batch_server.GetDocumentCount(), server.GetDocumentCount());
+    for (int index = 0; index < server.GetDocumentCount(); ++index) {
+        const int document_id = server.GetDocumentId(index);
+        ASSERT_EQUAL(batch_server.GetDocumentId(index), document_id);
+        ASSERT(batch_server.GetWordFrequencies(document_id) == server.GetWordFrequencies(document_id));
+    }
+    for (int word = 0; word < 900; ++word) {
+        const string query = "w"s + to_string(word) + " w"s + to_string(word / 2) + " -w"s + to_string(word + 1);
+        ASSERT_EQUAL(batch_server.GetDocumentFreq("w"s + to_string(word)), server.GetDocumentFreq("w"s + to_string(word)));
+        AssertEqualDocuments(batch_server.FindTopDocuments(query), server.FindTopDocuments(query), query);
+        AssertEqualDocuments(batch_server.FindTopDocuments(execution::par, query, DocumentStatus::BANNED),
+            server.FindTopDocuments(query, DocumentStatus::BANNED), query);
+    }
+}
+
+//     ,    ;     
+inline void TestConcurrentSearchServer() {
+    using namespace std;
+    SearchServer reference_server("and"s);
+    for (int document_id = 0; document_id < 100; ++document_id) {
+        reference_server.AddDocument(document_id, "cat w"s + to_string(document_id), DocumentStatus::ACTUAL, { 1 });
+    }
+    ConcurrentSearchServer server(reference_server);
+
+    atomic<bool> is_done = false;
+    atomic<int> inconsistent_read_count = 0;
+    atomic<int> read_count = 0;
+    vector<thread> readers;
+    for (int i = 0; i < 3; ++i) {
+        readers.emplace_back([&] {
+            while (!is_done) {
+                //      cat,         
+                const shared_ptr<const SearchServer> snapshot = server.GetSnapshot();
+                const int document_count = snapshot->GetDocumentCount();
+                const vector<Document> found_docs = snapshot->FindTopDocuments("cat"s,
+                    [](int document_id, DocumentStatus status, int rating) { return true; }, 1000000);
+                if (static_cast<int>(found_docs.size()) != document_count) {
+                    ++inconsistent_read_count;
+                }
+                server.FindTopDocuments("cat w5"s);
+                ++read_count;
+            }
+        });
+    }
+
+    for (int batch_index = 0; batch_index < 50; ++batch_index) {
+        vector<DocumentInput> batch;
+        vector<string> texts;
+        for (int i = 0; i < 10; ++i) {
+            texts.push_back("cat w"s + to_string(batch_index * 7 + i));
+        }
+        for (int i = 0; i < 10; ++i) {
+            batch.push_back({ 100 + batch_index * 10 + i, texts[i], DocumentStatus::ACTUAL, { i } });
+        }
+        server.AddDocuments(batch);
+        reference_server.AddDocuments(batch);
+        server.RemoveDocument(batch_index * 3);
+        reference_server.RemoveDocument(batch_index * 3);
+        //   ,  - ,    
+        try {
+            server.Update([](SearchServer& search_server) {
+                search_server.AddDocument(100000, "cat"s, DocumentStatus::ACTUAL, {});
+                search_server.AddDocument(100, "cat"s, DocumentStatus::ACTUAL, {});
+            });
+            ASSERT_HINT(false, "invalid_argument expected"s);
+        }
+        catch (const invalid_argument&) {
+        }
+    }
+    is_done = true;
+    for (thread& reader : readers) {
+        reader.join();
+    }
+    ASSERT_EQUAL(inconsistent_read_count.load(), 0);
+    ASSERT(read_count > 0);
+
+    //       
+    for (int replica = 0; replica < 2; ++replica) {
+        ASSERT_EQUAL(server.GetDocumentCount(), reference_server.GetDocumentCount());
+        for (int word = 0; word < 400; word += 3) {
+            const string query = "w"s + to_string(word) + " w"s + to_string(word + 1);
+            AssertEqualDocuments(server.FindTopDocuments(query), reference_server.FindTopDocuments(query), query);
+        }
+        bool is_missing = false;
+        try {
+            server.MatchDocument("cat"s, 100000);
+        }
+        catch (const out_of_range&) {
+            is_missing = true;
+        }
+        ASSERT(is_missing);
+        server.Update([](SearchServer&) {});
+    }
+}
+
+//         ,   ,    
+inline void TestCompressedPostingsMatchUncompressed() {
+    using namespace std;
+    mt19937 generator(5);
+    SearchServer server("w0 w1"s);
+    //      
+    const auto add_documents = [&generator](vector<SearchServer*> servers, int first_id, int count) {
+        for (int document_id = first_id; document_id < first_id + count; ++document_id) {
+            const string text = MakeRandomText(generator, 1 + generator() % 10, 40);
+            const DocumentStatus status = static_cast<DocumentStatus>(generator() % 4);
+            const vector<int> ratings = { static_cast<int>(generator() % 10) - 3 };
+            for (SearchServer* target : servers) {
+                target->AddDocument(document_id, text, status, ratings);
+            }
+        }
+    };
+    add_documents({ &server }, 0, 3000);
+    SearchServer compressed_server = server;
+    compressed_server.CompressPostings();
+    ASSERT(compressed_server.GetPostingMemoryUsage() < server.GetPostingMemoryUsage());
+
+    const auto check = [&](const SearchServer& expected_server, const SearchServer& checked_server, const string& hint) {
+        const auto is_rated = [](int document_id, DocumentStatus status, int rating) { return rating > 0; };
+        for (int word = 0; word < 40; word += 3) {
+            const string query = "w"s + to_string(word) + " w"s + to_string(word + 1) + " w"s + to_string(word + 5)
+                + (word % 2 == 0 ? " -w"s + to_string(word + 2) : ""s);
+            AssertEqualDocuments(checked_server.FindTopDocuments(query, DocumentStatus::ACTUAL, 10),
+                expected_server.FindTopDocuments(query, DocumentStatus::ACTUAL, 10), hint + query);
+            AssertEqualDocuments(checked_server.FindTopDocuments(query, is_rated, 10),
+                expected_server.FindTopDocuments(query, is_rated, 10), hint + query);
+            AssertEqualDocuments(checked_server.FindTopDocuments(execution::par, query, DocumentStatus::BANNED, 10),
+                expected_server.FindTopDocuments(query, DocumentStatus::BANNED, 10), hint + query);
+            AssertEqualDocuments(checked_server.FindTopDocuments(execution::par, query, is_rated, 10),
+                expected_server.FindTopDocuments(query, is_rated, 10), hint + query);
+            for (int index = 0; index < expected_server.GetDocumentCount(); index += 97) {
+                const int document_id = expected_server.GetDocumentId(index);
+                ASSERT_HINT(checked_server.MatchDocument(query, document_id)
+                    == expected_server.MatchDocument(query, document_id), hint + query);
+                ASSERT_HINT(checked_server.MatchDocument(execution::par, query, document_id)
+                    == expected_server.MatchDocument(query, document_id), hint + query);
+            }
+        }
+    };
+    check(server, compressed_server, "compressed: "s);
+
+    //      
+    for (int document_id = 0; document_id < 3000; document_id += 3) {
+        if (document_id % 2 == 0) {
+            continue;
+        }
+        server.RemoveDocument(document_id);
+        compressed_server.RemoveDocument(document_id);
+    }
+    for (int document_id = 0; document_id < 3000; document_id += 2) {
+        server.RemoveDocument(document_id);
+        compressed_server.RemoveDocument(document_id);
+    }
+    check(server, compressed_server, "removed: "s);
+    server.Compact();
+    compressed_server.Compact(execution::par);
+    ASSERT(compressed_server.GetPostingMemoryUsage() < server.GetPostingMemoryUsage());
+    check(server, compressed_server, "compacted: "s);
+
+    //        
+    const string path = (filesystem::temp_directory_path() / "search_server_compressed.snapshot").string();
+    compressed_server.SaveSnapshot(path);
+    const SearchServer loaded_server = SearchServer::LoadSnapshot(path);
+    filesystem::remove(path);
+    check(server, loaded_server, "snapshot: "s);
+
+    //   ,      
+    add_documents({ &server, &compressed_server }, 3000, 500);
+    check(server, compressed_server, "added: "s);
+    compressed_server.CompressPostings();
+    check(server, compressed_server, "compressed again: "s);
+}
+
+//            ,        
+inline void TestCompressedPostingListRoundTrip() {
+    using namespace std;
+    mt19937 generator(8);
+    for (const size_t size : { 0u, 1u, 127u, 128u, 129u, 1000u }) {
+        vector<int> documents;
+        vector<double> term_freqs;
+        int document_id = 0;
+        for (size_t i = 0; i < size; ++i) {
+            document_id += 1 + generator() % (i % 3 == 0 ? 3 : 5000);
+            documents.push_back(document_id);
+            //   SearchServer: 1 / ,   ,   
+            const double inverse_length = 1.0 / (1 + generator() % 1000);
+            double term_freq = 0.0;
+            for (unsigned count = 1 + generator() % 5; count > 0; --count) {
+                term_freq += inverse_length;
+            }
+            const double odd_term_freqs[] = { 0.3, 1e-300, 0.0, 2.5, 0.1 + 0.2 };
+            term_freqs.push_back(i % 7 == 3 ? odd_term_freqs[i / 7 % 5] : term_freq);
+        }
+        const string hint = "size "s + to_string(size);
+        const CompressedPostingList postings(documents, term_freqs);
+        ASSERT_EQUAL_HINT(postings.size(), size, hint);
+        ASSERT_HINT(postings.GetDocuments() == documents, hint);
+        if (size > 0) {
+            ASSERT_EQUAL_HINT(postings.GetMaxTermFreq(), *max_element(term_freqs.begin(), term_freqs.end()), hint);
+        }
+
+        size_t position = 0;
+        for (auto cursor = postings.begin(); !cursor.AtEnd(); cursor.Next(), ++position) {
+            ASSERT_EQUAL_HINT(cursor.GetDocument(), documents[position], hint);
+            ASSERT_EQUAL_HINT(cursor.GetTermFreq(), term_freqs[position], hint);
+            const size_t block_begin = position / CompressedPostingList::BLOCK_SIZE * CompressedPostingList::BLOCK_SIZE;
+            const size_t block_end = min(size, block_begin + CompressedPostingList::BLOCK_SIZE);
+            ASSERT_EQUAL_HINT(cursor.GetBlockMaxTermFreq(),
+                *max_element(term_freqs.begin() + block_begin, term_freqs.begin() + block_end), hint);
+        }
+        ASSERT_EQUAL_HINT(position, size, hint);
+
+        //       
+        for (int step : { 1, 97, 5000, 100000 }) {
+            auto cursor = postings.begin();
+            for (int target = 0; target <= document_id + step; target += step) {
+                cursor.SkipTo(target);
+                const auto it = lower_bound(documents.begin(), documents.end(), target);
+                ASSERT_EQUAL_HINT(cursor.AtEnd(), it == documents.end(), hint);
+                if (it != documents.end()) {
+                    ASSERT_EQUAL_HINT(cursor.GetDocument(), *it, hint);
+                    ASSERT_EQUAL_HINT(cursor.GetTermFreq(), term_freqs[it - documents.begin()], hint);
+                }
+            }
+        }
+        for (size_t i = 0; i < size; i += 13) {
+            ASSERT_HINT(postings.Contains(documents[i]), hint);
+            ASSERT_HINT(!postings.Contains(documents[i] + 1) || binary_search(documents.begin(), documents.end(),
+                documents[i] + 1), hint);
+        }
+    }
+}
+
+//      :     Compact     
+inline void TestRemoveDocumentLeavesCompactionToOwner() {
+    using namespace std;
+    mt19937 generator(7);
+    vector<string> texts;
+    for (int document_id = 0; document_id < 600; ++document_id) {
+        texts.push_back(MakeRandomText(generator, 1 + generator() % 8, 30));
+    }
+    const auto is_kept = [](int document_id) { return document_id % 5 == 0; };
+    SearchServer fresh_server("w0"s);
+    for (int document_id = 0; document_id < 600; ++document_id) {
+        if (is_kept(document_id)) {
+            fresh_server.AddDocument(document_id, texts[document_id], DocumentStatus::ACTUAL, { document_id % 7 });
+        }
+    }
+    const auto check = [&](const SearchServer& server, const string& hint) {
+        ASSERT_EQUAL_HINT(server.GetDocumentCount(), fresh_server.GetDocumentCount(), hint);
+        for (int word = 0; word < 30; word += 2) {
+            const string query = "w"s + to_string(word) + " w"s + to_string(word + 1) + " -w"s + to_string(word + 3);
+            AssertEqualDocuments(server.FindTopDocuments(query), fresh_server.FindTopDocuments(query), hint + query);
+            AssertEqualDocuments(server.FindTopDocuments(execution::par, query), fresh_server.FindTopDocuments(query),
+                hint + query);
+        }
+        for (int index = 0; index < fresh_server.GetDocumentCount(); ++index) {
+            const int document_id = fresh_server.GetDocumentId(index);
+            ASSERT_EQUAL_HINT(server.GetDocumentId(index), document_id, hint);
+            ASSERT_HINT(server.GetWordFrequencies(document_id) == fresh_server.GetWordFrequencies(document_id), hint);
+        }
+        ASSERT_HINT(server.GetWordFrequencies(1).empty(), hint);
+    };
+
+    for (const bool is_compressed : { false, true }) {
+        const string hint = is_compressed ? "compressed: "s : "plain: "s;
+        SearchServer server("w0"s);
+        for (int document_id = 0; document_id < 600; ++document_id) {
+            server.AddDocument(document_id, texts[document_id], DocumentStatus::ACTUAL, { document_id % 7 });
+        }
+        if (is_compressed) {
+            server.CompressPostings();
+        }
+        for (int document_id = 0; document_id < 600; ++document_id) {
+            if (!is_kept(document_id)) {
+                server.RemoveDocument(document_id);
+            }
+        }
+        //    ,     
+        ASSERT_EQUAL_HINT(server.GetRemovedDocumentCount(), 480, hint);
+        check(server, hint + "removed: "s);
+
+        const uint64_t generation = server.GetGeneration();
+        server.Compact(execution::par);
+        ASSERT_EQUAL_HINT(server.GetRemovedDocumentCount(), 0, hint);
+        ASSERT_EQUAL_HINT(server.GetGeneration(), generation, hint);
+        check(server, hint + "compacted: "s);
+    }
+}
+
+//        1/8     
+inline void TestLatencyHistogram() {
+    using namespace std;
+    LatencyHistogram empty_histogram;
+    ASSERT_EQUAL(empty_histogram.GetCount(), 0u);
+    ASSERT_EQUAL(empty_histogram.GetPercentile(0.5), 0u);
+
+    //        
+    LatencyHistogram small_histogram;
+    for (uint64_t value = 0; value < 16; ++value) {
+        small_histogram.Record(value);
+    }
+    ASSERT_EQUAL(small_histogram.GetCount(), 16u);
+    ASSERT_EQUAL(small_histogram.GetSum(), 120u);
+    ASSERT_EQUAL(small_histogram.GetMax(), 15u);
+    ASSERT_EQUAL(small_histogram.GetPercentile(0.0), 0u);
+    ASSERT_EQUAL(small_histogram.GetPercentile(0.5), 7u);
+    ASSERT_EQUAL(small_histogram.GetPercentile(1.0), 15u);
+
+    //    ,   
+    LatencyHistogram shared_bucket_histogram;
+    shared_bucket_histogram.Record(16);
+    ASSERT_EQUAL(shared_bucket_histogram.GetPercentile(1.0), 16u);
+    shared_bucket_histogram.Record(17);
+    shared_bucket_histogram.Record(18);
+    ASSERT_EQUAL(shared_bucket_histogram.GetPercentile(0.3), 17u);
+    ASSERT_EQUAL(shared_bucket_histogram.GetPercentile(1.0), 18u);
+
+    LatencyHistogram histogram;
+    for (uint64_t i = 1; i <= 1000; ++i) {
+        histogram.Record(i * 1000);
+    }
+    for (double fraction : { 0.01, 0.5, 0.9, 0.99, 1.0 }) {
+        const uint64_t expected = static_cast<uint64_t>(ceil(fraction * 1000)) * 1000;
+        const uint64_t percentile = histogram.GetPercentile(fraction);
+        ASSERT_HINT(percentile >= expected && percentile <= expected + expected / 8, to_string(fraction));
+    }
+    ASSERT_EQUAL(histogram.GetPercentile(1.0), 1000000u);
+
+    LatencyHistogram extreme_histogram;
+    extreme_histogram.Record(numeric_limits<uint64_t>::max());
+    extreme_histogram.Record(uint64_t{ 1 } << 40);
+    ASSERT_EQUAL(extreme_histogram.GetPercentile(1.0), numeric_limits<uint64_t>::max());
+    const uint64_t median = extreme_histogram.GetPercentile(0.5);
+    ASSERT(median >= (uint64_t{ 1 } << 40) && median <= (uint64_t{ 1 } << 40) + (uint64_t{ 1 } << 37));
+}
+
+//Explain      
+inline void TestExplainStagesAndCounters() {
+    using namespace std;
+    SearchServer server("and"s);
+    for (int document_id = 0; document_id < 7; ++document_id) {
+        server.AddDocument(document_id, "cat"s, DocumentStatus::ACTUAL, { 1 });
+    }
+    server.AddDocument(7, "cat and dog"s, DocumentStatus::ACTUAL, { 1 });
+    server.AddDocument(8, "bird"s, DocumentStatus::ACTUAL, { 1 });
+    server.AddDocument(9, "cat"s, DocumentStatus::BANNED, { 1 });
+
+    //    -  ,   - ,   
+    const QueryTrace trace = server.Explain("cat mouse and -dog"s);
+    ASSERT_EQUAL(trace.GetCounter(QueryCounter::TERMS_RESOLVED), 2u);
+    ASSERT_EQUAL(trace.GetCounter(QueryCounter::POSTINGS_VISITED), 8u);
+    ASSERT_EQUAL(trace.GetCounter(QueryCounter::DOCUMENTS_SCORED), 7u);
+    ASSERT_EQUAL(trace.GetCounter(QueryCounter::RESULTS_DROPPED), 2u);
+    uint64_t total_nanoseconds = 0;
+    for (size_t stage = 0; stage < QUERY_STAGE_COUNT; ++stage) {
+        total_nanoseconds += trace.GetStageNanoseconds(static_cast<QueryStage>(stage));
+    }
+    ASSERT_EQUAL(trace.GetTotalNanoseconds(), total_nanoseconds);
+    ASSERT(trace.GetTotalNanoseconds() > 0);
+
+    const QueryTrace banned_trace = server.Explain("cat"s, DocumentStatus::BANNED);
+    ASSERT_EQUAL(banned_trace.GetCounter(QueryCounter::TERMS_RESOLVED), 1u);
+    ASSERT_EQUAL(banned_trace.GetCounter(QueryCounter::POSTINGS_VISITED), 1u);
+    ASSERT_EQUAL(banned_trace.GetCounter(QueryCounter::DOCUMENTS_SCORED), 1u);
+    ASSERT_EQUAL(banned_trace.GetCounter(QueryCounter::RESULTS_DROPPED), 0u);
+
+    const QueryTrace empty_trace = server.Explain("mouse"s);
+    ASSERT_EQUAL(empty_trace.GetCounter(QueryCounter::TERMS_RESOLVED), 0u);
+    ASSERT_EQUAL(empty_trace.GetCounter(QueryCounter::POSTINGS_VISITED), 0u);
+}
+
+//     ,       
+inline void TestInstrumentedSearchServer() {
+    using namespace std;
+    SearchServer server("and"s);
+    for (int document_id = 0; document_id < 100; ++document_id) {
+        server.AddDocument(document_id, document_id % 2 == 0 ? "cat and dog"s : "cat"s,
+            document_id % 3 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL, { document_id % 5 });
+    }
+    const InstrumentedSearchServer instrumented_server(server);
+    const PreparedQuery prepared_query = server.Prepare("cat -dog"s);
+    const auto is_even = [](int document_id, DocumentStatus status, int rating) { return document_id % 2 == 0; };
+    CancellationSource cancellation_source;
+    const CancellationToken cancellation_token = cancellation_source.GetToken();
+    CorpusStatistics corpus_statistics;
+    corpus_statistics.document_count = 1000;
+    corpus_statistics.document_freqs["cat"s] = 10;
+
+    AssertEqualDocuments(instrumented_server.FindTopDocuments("cat -dog"s), server.FindTopDocuments("cat -dog"s), "raw"s);
+    AssertEqualDocuments(instrumented_server.FindTopDocuments("cat"s, DocumentStatus::BANNED, 10),
+        server.FindTopDocuments("cat"s, DocumentStatus::BANNED, 10), "status"s);
+    AssertEqualDocuments(instrumented_server.FindTopDocuments("cat"s, is_even),
+        server.FindTopDocuments("cat"s, is_even), "predicate"s);
+    AssertEqualDocuments(instrumented_server.FindTopDocuments(execution::par, "cat dog"s),
+        server.FindTopDocuments(execution::par, "cat dog"s), "par"s);
+    AssertEqualDocuments(instrumented_server.FindTopDocuments(prepared_query), server.FindTopDocuments(prepared_query),
+        "prepared"s);
+    AssertEqualDocuments(instrumented_server.FindTopDocuments(execution::par, prepared_query, DocumentStatus::BANNED),
+        server.FindTopDocuments(execution::par, prepared_query, DocumentStatus::BANNED), "par prepared"s);
+    AssertEqualDocuments(instrumented_server.FindTopDocuments(execution::seq, "cat"s, is_even, 10, cancellation_token),
+        server.FindTopDocuments(execution::seq, "cat"s, is_even, 10, cancellation_token), "cancellable"s);
+    AssertEqualDocuments(instrumented_server.FindTopDocuments(execution::par, "cat"s, is_even, 10, corpus_statistics),
+        server.FindTopDocuments(execution::par, "cat"s, is_even, 10, corpus_statistics), "corpus"s);
+
+    const QueryStats& stats = instrumented_server.GetStats();
+    ASSERT_EQUAL(stats.GetTotalHistogram().GetCount(), 8u);
+    ASSERT_EQUAL(stats.GetStageHistogram(QueryStage::PARSE).GetCount(), 8u);
+    ASSERT_EQUAL(stats.GetCounterHistogram(QueryCounter::TERMS_RESOLVED).GetSum(), 12u);
+    ASSERT_EQUAL(stats.GetCounterHistogram(QueryCounter::TERMS_RESOLVED).GetMax(), 2u);
+
+    // ,   ,  
+    cancellation_source.Cancel();
+    try {
+        instrumented_server.FindTopDocuments(execution::par, "cat"s, is_even, 10, cancellation_token);
+        ASSERT_HINT(false, "OperationCancelled expected"s);
+    }
+    catch (const OperationCancelled&) {
+    }
+    ASSERT_EQUAL(stats.GetTotalHistogram().GetCount(), 8u);
+
+    const int thread_count = 4;
+    const int search_count = 500;
+    vector<thread> threads;
+    for (int thread_index = 0; thread_index < thread_count; ++thread_index) {
+        threads.emplace_back([&instrumented_server, thread_index] {
+            for (int i = 0; i < search_count; ++i) {
+                if ((i + thread_index) % 2 == 0) {
+                    instrumented_server.FindTopDocuments("cat"s);
+                }
+                else {
+                    instrumented_server.FindTopDocuments(execution::par, "cat -dog"s);
+                }
+            }
+        });
+    }
+    for (thread& search_thread : threads) {
+        search_thread.join();
+    }
+    const uint64_t total_count = 8 + thread_count * search_count;
+    ASSERT_EQUAL(stats.GetTotalHistogram().GetCount(), total_count);
+    ASSERT_EQUAL(stats.GetTotalHistogram().GetPercentile(1.0), stats.GetTotalHistogram().GetMax());
+    for (size_t stage = 0; stage < QUERY_STAGE_COUNT; ++stage) {
+        ASSERT_EQUAL(stats.GetStageHistogram(static_cast<QueryStage>(stage)).GetCount(), total_count);
+    }
+    ASSERT_EQUAL(stats.GetCounterHistogram(QueryCounter::TERMS_RESOLVED).GetSum(),
+        12u + thread_count * search_count / 2 * 3);
+
+    //       
+    LatencyHistogram histogram;
+    threads.clear();
+    for (int thread_index = 0; thread_index < thread_count; ++thread_index) {
+        threads.emplace_back([&histogram, thread_index] {
+            for (uint64_t value = 0; value < 10000; ++value) {
+                histogram.Record(value * thread_count + thread_index);
+            }
+        });
+    }
+    for (thread& record_thread : threads) {
+        record_thread.join();
+    }
+    const uint64_t value_count = 10000 * thread_count;
+    ASSERT_EQUAL(histogram.GetCount(), value_count);
+    ASSERT_EQUAL(histogram.GetSum(), value_count * (value_count - 1) / 2);
+    ASSERT_EQUAL(histogram.GetMax(), value_count - 1);
+    ASSERT_EQUAL(histogram.GetPercentile(1.0), value_count - 1);
+}
+
+//        MAX_REQUEST_COUNT,    
+inline void TestRequestQueueWindow() {
+    using namespace std;
+    SearchServer server("and"s);
+    server.AddDocument(1, "cat"s, DocumentStatus::ACTUAL, { 1 });
+    server.AddDocument(2, "cat and dog"s, DocumentStatus::ACTUAL, { 2 });
+
+    //         
+    RequestQueue short_queue(server, chrono::milliseconds(300));
+    ASSERT_EQUAL(short_queue.GetRequestCount(), 0);
+    short_queue.AddFindRequest("cat"s);
+    short_queue.AddFindRequest("mouse"s);
+    ASSERT_EQUAL(short_queue.GetRequestCount(), 2);
+    ASSERT_EQUAL(short_queue.GetNoResultRequests(), 1);
+    ASSERT_EQUAL(short_queue.GetFoundDocumentCount(), 2);
+    this_thread::sleep_for(chrono::milliseconds(200));
+    short_queue.AddFindRequest("dog"s);
+    ASSERT_EQUAL(short_queue.GetRequestCount(), 3);
+    this_thread::sleep_for(chrono::milliseconds(200));
+    ASSERT_EQUAL(short_queue.GetRequestCount(), 1);
+    ASSERT_EQUAL(short_queue.GetNoResultRequests(), 0);
+    ASSERT_EQUAL(short_queue.GetFoundDocumentCount(), 1);
+    this_thread::sleep_for(chrono::milliseconds(200));
+    ASSERT_EQUAL(short_queue.GetRequestCount(), 0);
+    ASSERT_EQUAL(short_queue.GetFoundDocumentCount(), 0);
+
+    //  MAX_REQUEST_COUNT    
+    RequestQueue queue(server);
+    const int request_count = RequestQueue::MAX_REQUEST_COUNT + 100;
+    int expected_no_result_count = 0;
+    long long expected_found_document_count = 0;
+    for (int i = 0; i < request_count; ++i) {
+        const string query = i % 3 == 0 ? "mouse"s : i % 3 == 1 ? "cat"s : "dog"s;
+        const int document_count = static_cast<int>(queue.AddFindRequest(query).size());
+        if (i >= request_count - RequestQueue::MAX_REQUEST_COUNT) {
+            expected_no_result_count += document_count == 0 ? 1 : 0;
+            expected_found_document_count += document_count;
+        }
+    }
+    ASSERT_EQUAL(queue.GetRequestCount(), RequestQueue::MAX_REQUEST_COUNT);
+    ASSERT_EQUAL(queue.GetNoResultRequests(), expected_no_result_count);
+    ASSERT_EQUAL(queue.GetFoundDocumentCount(), expected_found_document_count);
+}
+
+//         
+inline void TestRequestQueueConcurrentRequests() {
+    using namespace std;
+    SearchServer server("and"s);
+    server.AddDocument(1, "cat"s, DocumentStatus::ACTUAL, { 1 });
+    RequestQueue queue(server);
+    const int thread_count = 4;
+    //      ,   
+    const auto add_requests = [&queue](int request_count) {
+        vector<thread> threads;
+        for (int thread_index = 0; thread_index < thread_count; ++thread_index) {
+            threads.emplace_back([&queue, thread_index, request_count] {
+                for (int i = 0; i < request_count; ++i) {
+                    queue.AddFindRequest(thread_index % 2 == 0 ? "cat"s : "mouse"s);
+                    queue.GetRequestCount();
+                }
+            });
+        }
+        for (thread& request_thread : threads) {
+            request_thread.join();
+        }
+    };
+
+    add_requests(300);
+    ASSERT_EQUAL(queue.GetRequestCount(), thread_count * 300);
+    ASSERT_EQUAL(queue.GetNoResultRequests(), thread_count * 300 / 2);
+    ASSERT_EQUAL(queue.GetFoundDocumentCount(), thread_count * 300 / 2);
+
+    add_requests(700);
+    ASSERT_EQUAL(queue.GetRequestCount(), RequestQueue::MAX_REQUEST_COUNT);
+    ASSERT_EQUAL(queue.GetNoResultRequests() + queue.GetFoundDocumentCount(), RequestQueue::MAX_REQUEST_COUNT);
+}
+
+//            ,   
+inline void TestParallelFindTopDocumentsMatchesSequential() {
+    using namespace std;
+    mt19937 generator(10);
+    SearchServer server("w0"s);
+    //     ,    
+    for (int document_id = 0; document_id < 5000; ++document_id) {
+        server.AddDocument(document_id, MakeRandomText(generator, 1 + generator() % 12, 50),
+            static_cast<DocumentStatus>(generator() % 4), { static_cast<int>(generator() % 7) - 3 });
+    }
+    for (int document_id = 0; document_id < 5000; document_id += 11) {
+        server.RemoveDocument(document_id);
+    }
+    const auto is_even = [](int document_id, DocumentStatus status, int rating) { return document_id % 2 == 0; };
+    for (int query_index = 0; query_index < 100; ++query_index) {
+        const string query = MakeRandomQuery(generator, 1 + generator() % 5, 50);
+        //      
+        for (const size_t max_result_count : { size_t(0), size_t(1), size_t(5), size_t(37), numeric_limits<size_t>::max() }) {
+            const string hint = query + " top "s + to_string(max_result_count);
+            for (int status = 0; status < 4; ++status) {
+                AssertEqualDocuments(
+                    server.FindTopDocuments(execution::par, query, static_cast<DocumentStatus>(status), max_result_count),
+                    server.FindTopDocuments(execution::seq, query, static_cast<DocumentStatus>(status), max_result_count),
+                    hint);
+            }
+            AssertEqualDocuments(server.FindTopDocuments(execution::par, query, is_even, max_result_count),
+                server.FindTopDocuments(execution::seq, query, is_even, max_result_count), hint);
+        }
+        AssertEqualDocuments(server.FindTopDocuments(execution::par, query), server.FindTopDocuments(query), query);
+    }
+}
+
+//  MatchDocument    :    ,  ,   
+inline void TestMatchDocumentWordsOutliveQuery() {
+    using namespace std;
+    SearchServer server("and"s);
+    server.AddDocument(1, "white cat and fancy collar"s, DocumentStatus::ACTUAL, { 1 });
+    server.AddDocument(2, "black dog"s, DocumentStatus::ACTUAL, { 1 });
+
+    vector<string_view> words;
+    vector<string_view> par_words;
+    {
+        string query = "collar white cat -dog"s;
+        words = get<0>(server.MatchDocument(query, 1));
+        par_words = get<0>(server.MatchDocument(execution::par, query, 1));
+        //  :       
+        query.assign(query.size(), '#');
+    }
+    const vector<string_view> expected_words = { "cat"sv, "collar"sv, "white"sv };
+    ASSERT(words == expected_words);
+    ASSERT(par_words == expected_words);
+    const char* const cat_data = words[0].data();
+
+    //   ,        
+    for (int document_id = 3; document_id < 3000; ++document_id) {
+        server.AddDocument(document_id, "word"s + to_string(document_id) + " cat"s, DocumentStatus::ACTUAL, { 1 });
+    }
+    server.RemoveDocument(1);
+    server.Compact();
+    ASSERT(words == expected_words);
+    ASSERT(par_words == expected_words);
+    ASSERT(words[0].data() == cat_data);
+    ASSERT(get<0>(server.MatchDocument("cat"s, 3))[0].data() == cat_data);
+
+    //       
+    const SearchServer copy = server;
+    const vector<string_view> copy_words = get<0>(copy.MatchDocument("cat"s, 3));
+    ASSERT(copy_words == vector<string_view>{ "cat"sv });
+    ASSERT(copy_words[0].data() != cat_data);
+}
+
+//      , ,    
+inline void TestTermIdsSurviveAddAndRemove() {
+    using namespace std;
+    InvertedIndex index;
+    const vector<string> words = { "cat"s, "dog"s, "fish"s, "bird"s };
+    for (int document = 0; document < 4; ++document) {
+        index.AddDocument(document, DocumentStatus::ACTUAL, { { words[document], 1.0 } });
+    }
+    vector<InvertedIndex::TermId> term_ids;
+    for (const string& word : words) {
+        term_ids.push_back(index.FindTerm(word));
+        ASSERT(term_ids.back() != InvertedIndex::NO_TERM);
+    }
+    ASSERT_EQUAL(set<InvertedIndex::TermId>(term_ids.begin(), term_ids.end()).size(), words.size());
+    ASSERT_EQUAL(index.FindTerm("horse"s), InvertedIndex::NO_TERM);
+
+    const auto check = [&](const InvertedIndex& checked_index, const string& hint) {
+        for (size_t i = 0; i < words.size(); ++i) {
+            ASSERT_EQUAL_HINT(checked_index.FindTerm(words[i]), term_ids[i], hint);
+            ASSERT_EQUAL_HINT(checked_index.GetTerm(term_ids[i]), words[i], hint);
+        }
+    };
+    //     ,    
+    for (int document = 4; document < 2004; ++document) {
+        index.AddDocument(document, static_cast<DocumentStatus>(document % 4),
+            { { "word"s + to_string(document), 0.5 }, { words[document % 4], 0.5 } });
+    }
+    check(index, "added: "s);
+    ASSERT(index.FindTerm("word4"s) != InvertedIndex::NO_TERM);
+
+    //         
+    vector<int> new_documents(2004, -1);
+    int next_document = 0;
+    for (int document = 0; document < 2004; ++document) {
+        if (document % 4 == 1 || document % 3 == 0) {
+            index.RemoveDocument(document);
+        }
+        else {
+            new_documents[document] = next_document++;
+        }
+    }
+    ASSERT_EQUAL(index.GetDocumentFreq(term_ids[1]), 0u);
+    check(index, "removed: "s);
+    index.Compact(execution::par, new_documents);
+    check(index, "compacted: "s);
+    ASSERT_EQUAL(index.GetDocumentFreq(term_ids[1]), 0u);
+    ASSERT(index.GetPostings(term_ids[1], DocumentStatus::IRRELEVANT).empty());
+    ASSERT_EQUAL(index.GetDocumentFreq(term_ids[2]), index.GetPostings(term_ids[2], DocumentStatus::BANNED).size()
+        + index.GetPostings(term_ids[2], DocumentStatus::ACTUAL).size());
+
+    //      ,       
+    InvertedIndex copy;
+    {
+        const InvertedIndex source = index;
+        copy = source;
+    }
+    check(copy, "copied: "s);
+    copy.AddDocument(next_document, DocumentStatus::ACTUAL, { { "dog"s, 1.0 } });
+    ASSERT_EQUAL(copy.FindTerm("dog"s), term_ids[1]);
+    ASSERT_EQUAL(copy.GetDocumentFreq(term_ids[1]), 1u);
+}
+
+//  K        ,   id,   K
+inline void TestTopDocumentsLimitAndTies() {
+    using namespace std;
+    SearchServer server(""s);
+    //     0-39,    id
+    vector<Document> expected_docs;
+    for (int document_id = 0; document_id < 40; ++document_id) {
+        const int rating = document_id * 7 % 5;
+        server.AddDocument(document_id, "cat"s, DocumentStatus::ACTUAL, { rating });
+        expected_docs.push_back({ document_id, 0.0, rating });
+    }
+    sort(expected_docs.begin(), expected_docs.end(), [](const Document& lhs, const Document& rhs) {
+        return lhs.rating != rhs.rating ? lhs.rating > rhs.rating : lhs.id < rhs.id;
+    });
+    //       
+    for (int document_id = 40; document_id < 50; ++document_id) {
+        server.AddDocument(document_id, "cat dog"s, DocumentStatus::ACTUAL, { 100 + document_id });
+        expected_docs.push_back({ document_id, 0.0, 100 + document_id });
+    }
+    sort(expected_docs.begin() + 40, expected_docs.end(), [](const Document& lhs, const Document& rhs) {
+        return lhs.rating > rhs.rating;
+    });
+    for (int document_id = 50; document_id < 60; ++document_id) {
+        server.AddDocument(document_id, "bird"s, DocumentStatus::ACTUAL, { 0 });
+    }
+
+    const auto check = [&](const vector<Document>& found_docs, size_t max_result_count, const string& hint) {
+        ASSERT_EQUAL_HINT(found_docs.size(), min(max_result_count, expected_docs.size()), hint);
+        for (size_t i = 0; i < found_docs.size(); ++i) {
+            ASSERT_EQUAL_HINT(found_docs[i].id, expected_docs[i].id, hint);
+            ASSERT_EQUAL_HINT(found_docs[i].rating, expected_docs[i].rating, hint);
+            ASSERT_EQUAL_HINT(found_docs[i].relevance, found_docs[i < 40 ? 0 : 40].relevance, hint);
+        }
+    };
+    const auto is_any = [](int document_id, DocumentStatus status, int rating) { return true; };
+    for (const size_t max_result_count : { 0u, 1u, 5u, 39u, 40u, 41u, 50u, 1000u }) {
+        const string hint = "top "s + to_string(max_result_count);
+        check(server.FindTopDocuments("cat"s, DocumentStatus::ACTUAL, max_result_count), max_result_count, hint);
+        check(server.FindTopDocuments(execution::par, "cat"s, DocumentStatus::ACTUAL, max_result_count),
+            max_result_count, hint);
+        check(server.FindTopDocuments("cat"s, is_any, max_result_count), max_result_count, hint);
+        check(server.FindTopDocuments(execution::par, "cat"s, is_any, max_result_count), max_result_count, hint);
+    }
+    check(server.FindTopDocuments("cat"s), static_cast<size_t>(MAX_RESULT_DOCUMENT_COUNT), "default"s);
+    const vector<Document> all_docs = server.FindTopDocuments("cat"s, DocumentStatus::ACTUAL, 1000);
+    ASSERT(all_docs[39].relevance > all_docs[40].relevance + PRECISION);
+}
+
+//    :     ,     ,   
+inline void TestRelevanceAccumulatorResetBetweenQueries() {
+    using namespace std;
+    {
+        RelevanceAccumulator accumulator;
+        accumulator.BeginQuery(10, 2);
+        ASSERT(accumulator.Add(3, 0.5));
+        ASSERT(!accumulator.Add(3, 0.25));
+        ASSERT(accumulator.Add(7, 1.0));
+        ASSERT_EQUAL(accumulator.GetRelevance(3), 0.75);
+        ASSERT_EQUAL(accumulator.GetRelevance(7), 1.0);
+        accumulator.Reset(3);
+        accumulator.Reset(7);
+        accumulator.GetRangeBuffers(1).touched_ordinals.assign(100, 7);
+        accumulator.GetRangeBuffers(1).documents.assign(100, { 7, 1.0, 0 });
+
+        //  ,      ,   
+        for (const size_t document_count : { 10u, 11u, 1000u }) {
+            //   ,     
+            accumulator.BeginQuery(document_count, 3);
+            for (size_t range_index = 0; range_index < 3; ++range_index) {
+                ASSERT(accumulator.GetRangeBuffers(range_index).touched_ordinals.empty());
+                ASSERT(accumulator.GetRangeBuffers(range_index).documents.empty());
+            }
+            ASSERT(accumulator.GetRangeBuffers(1).touched_ordinals.capacity() >= 100u);
+            ASSERT(accumulator.GetRangeBuffers(1).documents.capacity() >= 100u);
+            accumulator.GetRangeBuffers(1).documents.assign(100, { 7, 1.0, 0 });
+            for (size_t ordinal = 0; ordinal < document_count; ++ordinal) {
+                ASSERT_EQUAL(accumulator.GetRelevance(static_cast<int>(ordinal)), 0.0);
+            }
+            ASSERT(accumulator.Add(3, 0.125));
+            ASSERT_EQUAL(accumulator.GetRelevance(3), 0.125);
+            accumulator.Reset(3);
+        }
+    }
+
+    //         ,     ,     
+    mt19937 generator(11);
+    SearchServer server("w0"s);
+    vector<string> queries;
+    for (int i = 0; i < 20; ++i) {
+        queries.push_back(MakeRandomQuery(generator, 1 + generator() % 4, 30));
+    }
+    for (int round = 0; round < 3; ++round) {
+        for (int document_id = round * 500; document_id < round * 500 + 500; ++document_id) {
+            server.AddDocument(document_id, MakeRandomText(generator, 1 + generator() % 8, 30), DocumentStatus::ACTUAL,
+                { static_cast<int>(generator() % 5) });
+        }
+        vector<vector<Document>> first_results;
+        for (const string& query : queries) {
+            first_results.push_back(server.FindTopDocuments(execution::par, query, DocumentStatus::ACTUAL, 1000));
+        }
+        for (int repeat = 0; repeat < 2; ++repeat) {
+            for (size_t i = 0; i < queries.size(); ++i) {
+                AssertEqualDocuments(server.FindTopDocuments(execution::par, queries[i], DocumentStatus::ACTUAL, 1000),
+                    first_results[i], queries[i]);
+                AssertEqualDocuments(server.FindTopDocuments(queries[i], DocumentStatus::ACTUAL, 1000),
+                    first_results[i], queries[i]);
+            }
+        }
+    }
+}
+
+// IDF  log(N / df),  ,  ,  ,   
+inline void TestInverseDocumentFreqAfterAddsAndRemoves() {
+    using namespace std;
+    mt19937 generator(12);
+    SearchServer server(""s);
+    //    
+    map<int, set<string>> live_documents;
+    const auto check = [&](const string& hint) {
+        for (int word_index = 0; word_index < 20; ++word_index) {
+            const string word = "w"s + to_string(word_index);
+            const int document_freq = static_cast<int>(count_if(live_documents.begin(), live_documents.end(),
+                [&word](const auto& document) { return document.second.count(word) > 0; }));
+            ASSERT_EQUAL_HINT(server.GetDocumentFreq(word), document_freq, hint + word);
+            const double expected_inverse_document_freq =
+                log(static_cast<double>(live_documents.size()) / document_freq);
+            for (const Document& document : server.FindTopDocuments(word, DocumentStatus::ACTUAL, 1000)) {
+                const double term_freq = server.GetWordFrequencies(document.id).at(word);
+                ASSERT_HINT(abs(document.relevance / term_freq - expected_inverse_document_freq) < 1e-12,
+                    hint + word);
+            }
+        }
+    };
+
+    int next_document_id = 0;
+    for (int round = 0; round < 6; ++round) {
+        //    ,      
+        vector<string> texts;
+        texts.reserve(100);
+        vector<DocumentInput> batch;
+        for (int i = 0; i < 100; ++i) {
+            const string& text = texts.emplace_back(MakeRandomText(generator, 1 + generator() % 6, 20));
+            const int document_id = next_document_id++;
+            const vector<string_view> words = SplitIntoWords(text);
+            live_documents[document_id] = set<string>(words.begin(), words.end());
+            if (round % 2 == 0) {
+                server.AddDocument(document_id, text, DocumentStatus::ACTUAL, { 1 });
+            }
+            else {
+                batch.push_back({ document_id, text, DocumentStatus::ACTUAL, { 1 } });
+            }
+        }
+        server.AddDocuments(execution::par, batch);
+        check("added "s + to_string(round) + ": "s);
+
+        for (int i = 0; i < 40 + round * 10 && !live_documents.empty(); ++i) {
+            auto it = live_documents.begin();
+            advance(it, generator() % live_documents.size());
+            server.RemoveDocument(it->first);
+            live_documents.erase(it);
+        }
+        check("removed "s + to_string(round) + ": "s);
+        if (round % 3 == 2) {
+            server.Compact();
+            check("compacted "s + to_string(round) + ": "s);
+        }
+    }
+}
+
+//MatchDocument: -      ,     
+inline void TestMatchDocumentMinusWordsAndPolicies() {
+    using namespace std;
+    SearchServer server("and"s);
+    server.AddDocument(1, "cat and dog and bird"s, DocumentStatus::BANNED, { 1 });
+    //  -     -,    
+    for (const string& query : { "cat dog bird -dog"s, "-bird cat"s, "cat -cat"s }) {
+        for (const auto& [words, status] : { server.MatchDocument(query, 1),
+            server.MatchDocument(execution::par, query, 1), server.MatchDocument(server.Prepare(query), 1) }) {
+            ASSERT_HINT(words.empty(), query);
+            ASSERT_EQUAL_HINT(static_cast<int>(status), static_cast<int>(DocumentStatus::BANNED), query);
+        }
+    }
+    //      -   
+    const vector<string_view> all_words = { "bird"sv, "cat"sv, "dog"sv };
+    ASSERT(get<0>(server.MatchDocument("dog cat bird cat -horse"s, 1)) == all_words);
+    ASSERT(get<0>(server.MatchDocument(execution::par, "dog cat bird cat -horse"s, 1)) == all_words);
+
+    mt19937 generator(13);
+    for (int document_id = 2; document_id < 300; ++document_id) {
+        server.AddDocument(document_id, MakeRandomText(generator, 1 + generator() % 10, 25),
+            static_cast<DocumentStatus>(generator() % 4), { 1 });
+    }
+    for (int query_index = 0; query_index < 200; ++query_index) {
+        const string query = MakeRandomQuery(generator, 1 + generator() % 8, 30);
+        const PreparedQuery prepared_query = server.Prepare(query);
+        for (int document_id = 2 + query_index % 7; document_id < 300; document_id += 7) {
+            const auto seq_result = server.MatchDocument(execution::seq, query, document_id);
+            ASSERT_HINT(server.MatchDocument(execution::par, query, document_id) == seq_result, query);
+            ASSERT_HINT(server.MatchDocument(execution::par, prepared_query, document_id) == seq_result, query);
+            const vector<string_view>& words = get<0>(seq_result);
+            ASSERT_HINT(is_sorted(words.begin(), words.end())
+                && adjacent_find(words.begin(), words.end()) == words.end(), query);
+        }
+    }
+    for (const bool is_parallel : { false, true }) {
+        try {
+            if (is_parallel) {
+                server.MatchDocument(execution::par, "cat"s, 1000);
+            }
+            else {
+                server.MatchDocument("cat"s, 1000);
+            }
+            ASSERT_HINT(false, "out_of_range expected"s);
+        }
+        catch (const out_of_range&) {
+        }
+    }
+}
+
+inline void TestSearchServer() {
+    RUN_TEST(TestSegmentedSearchServerMatchesSearchServer);
+    RUN_TEST(TestMaxScoreMatchesExhaustiveSearch);
+    RUN_TEST(TestFindDocumentsByStatusPartition);
+    RUN_TEST(TestDocumentBitmap);
+    RUN_TEST(TestExcludeMinusWordsWithBitmap);
+    RUN_TEST(TestShardedSearchServerMatchesSearchServer);
+    RUN_TEST(TestCancelSearch);
+    RUN_TEST(TestSnapshotSaveAndValidation);
+    RUN_TEST(TestCachedSearchServerAfterAssignment);
+    RUN_TEST(TestPreparedQueryOwnership);
+    RUN_TEST(TestProcessQueriesJoined);
+    RUN_TEST(TestRemoveDocumentsMatchesRebuiltServer);
+    RUN_TEST(TestAddDocumentsInParallelMatchesAddDocument);
+    RUN_TEST(TestConcurrentSearchServer);
+    RUN_TEST(TestCompressedPostingsMatchUncompressed);
+    RUN_TEST(TestCompressedPostingListRoundTrip);
+    RUN_TEST(TestRemoveDocumentLeavesCompactionToOwner);
+    RUN_TEST(TestLatencyHistogram);
+    RUN_TEST(TestExplainStagesAndCounters);
+    RUN_TEST(TestInstrumentedSearchServer);
+    RUN_TEST(TestRequestQueueWindow);
+    RUN_TEST(TestRequestQueueConcurrentRequests);
+    RUN_TEST(TestParallelFindTopDocumentsMatchesSequential);
+    RUN_TEST(TestMatchDocumentWordsOutliveQuery);
+    RUN_TEST(TestTermIdsSurviveAddAndRemove);
+    RUN_TEST(TestTopDocumentsLimitAndTies);
+    RUN_TEST(TestRelevanceAccumulatorResetBetweenQueries);
+    RUN_TEST(TestInverseDocumentFreqAfterAddsAndRemoves);
+    RUN_TEST(TestMatchDocumentMinusWordsAndPolicies);
+}
+
+template <typename T, typename U>
+void AssertEqualImpl(const T& t, const U& u, const std::string& t_str, const std::string& u_str, const std::string& file,
+    const std::string& func, unsigned line, const std::string& hint) {
+    if (t != u) {
+        using namespace std;
+        cerr << boolalpha;
+        cerr << file << "("s << line << "): "s << func << ": "s;
+        cerr << "ASSERT_EQUAL("s << t_str << ", "s << u_str << ") failed: "s;
+        cerr << t << " != "s << u << "."s;
+        if (!hint.empty()) {
+            cerr << " Hint: "s << hint;
+        }
+        cerr << endl;
+        abort();
+    }
+}
+
+template <typename TestFunc>
+void RunTestImpl(const TestFunc& func, const std::string& test_name) {
+    func();
+    using namespace std;
+    cerr << test_name << " OK"s << endl;
 }
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "process_queries.h"
+
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <thread>
+#include <utility>
+
+using namespace std;
+
+vector<vector<Document>> ProcessQueries(
+    const SearchServer& search_server,
+    const vector<string>& queries) {
+
+    vector<vector<Document>> documents_lists(queries.size());
+    transform(execution::par, queries.begin(), queries.end(), documents_lists.begin(),
+        [&search_server](const string& query) {
+            return search_server.FindTopDocuments(query);
+        });
+    return documents_lists;
+}
+
+JoinedDocuments::Iterator::Iterator(const JoinedDocuments* joined_documents, size_t query_index,
+    size_t document_index)
+    : joined_documents_(joined_documents), query_index_(query_index), document_index_(document_index) {
+    SkipEmptyQueries();
+}
+
+JoinedDocuments::Iterator::reference JoinedDocuments::Iterator::operator*() const {
+    return joined_documents_->results_[query_index_][document_index_];
+}
+
+JoinedDocuments::Iterator::pointer JoinedDocuments::Iterator::operator->() const {
+    return &**this;
+}
+
+JoinedDocuments::Iterator& JoinedDocuments::Iterator::operator++() {
+    ++document_index_;
+    SkipEmptyQueries();
+    return *this;
+}
+
+JoinedDocuments::Iterator JoinedDocuments::Iterator::operator++(int) {
+    Iterator previous = *this;
+    ++*this;
+    return previous;
+}
+
+bool JoinedDocuments::Iterator::operator==(const Iterator& other) const {
+    return joined_documents_ == other.joined_documents_
+        && query_index_ == other.query_index_
+        && document_index_ == other.document_index_;
+}
+
+bool JoinedDocuments::Iterator::operator!=(const Iterator& other) const {
+    return !(*this == other);
+}
+
+void JoinedDocuments::Iterator::SkipEmptyQueries() {
+    const vector<vector<Document>>& results = joined_documents_->results_;
+    while (query_index_ < joined_documents_->queries_.size()) {
+        if (query_index_ == results.size()) {
+            joined_documents_->RunNextQueries();
+        }
+        if (document_index_ < results[query_index_].size()) {
+            return;
+        }
+        ++query_index_;
+        document_index_ = 0;
+    }
+}
+
+JoinedDocuments::JoinedDocuments(const SearchServer& search_server, vector<string> queries)
+    : search_server_(search_server), queries_(move(queries)) {
+}
+
+JoinedDocuments::Iterator JoinedDocuments::begin() const {
+    return Iterator(this, 0, 0);
+}
+
+JoinedDocuments::Iterator JoinedDocuments::end() const {
+    return Iterator(this, queries_.size(), 0);
+}
+
+size_t JoinedDocuments::size() const {
+    while (results_.size() < queries_.size()) {
+        RunNextQueries();
+    }
+    return transform_reduce(results_.begin(), results_.end(), size_t{ 0 }, plus<>(),
+        [](const vector<Document>& documents) {
+            return documents.size();
+        });
+}
+
+void JoinedDocuments::RunNextQueries() const {
+    // Batches double, so the first results come quickly and long runs still
+    // give every core plenty of queries. Moving the per-query vectors keeps
+    // documents already handed out in place.
+    const size_t batch_begin = results_.size();
+    const size_t batch_size = max<size_t>(batch_begin, max(1u, thread::hardware_concurrency()) * 4);
+    const size_t batch_end = min(queries_.size(), batch_begin + batch_size);
+    results_.resize(batch_end);
+    transform(execution::par, queries_.begin() + batch_begin, queries_.begin() + batch_end,
+        results_.begin() + batch_begin,
+        [this](const string& query) {
+            return search_server_.FindTopDocuments(query);
+        });
+}
+
+JoinedDocuments ProcessQueriesJoined(
+    const SearchServer& search_server,
+    const vector<string>& queries) {
+    return JoinedDocuments(search_server, queries);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "document.h"
+#include "search_server.h"
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <vector>
+
+std::vector<std::vector<Document>> ProcessQueries(
+    const SearchServer& search_server,
+    const std::vector<std::string>& queries);
+
+// Results of several queries as one flat sequence. Queries run only when
+// iteration reaches them, a batch at a time on all cores, so the first
+// documents are available long before the last query is done. The server
+// must outlive the object and must not change while it is iterated.
+// Iteration of one object is not thread-safe.
+class JoinedDocuments {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Document;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Document*;
+        using reference = const Document&;
+
+        Iterator(const JoinedDocuments* joined_documents, size_t query_index, size_t document_index);
+
+        reference operator*() const;
+        pointer operator->() const;
+
+        Iterator& operator++();
+        Iterator operator++(int);
+
+        bool operator==(const Iterator& other) const;
+        bool operator!=(const Iterator& other) const;
+
+    private:
+        const JoinedDocuments* joined_documents_;
+        size_t query_index_;
+        size_t document_index_;
+
+        // Runs the queries it steps onto
+        void SkipEmptyQueries();
+    };
+
+    JoinedDocuments(const SearchServer& search_server, std::vector<std::string> queries);
+
+    Iterator begin() const;
+    Iterator end() const;
+
+    // Runs all remaining queries
+    size_t size() const;
+
+private:
+    const SearchServer& search_server_;
+    const std::vector<std::string> queries_;
+    // Results of the queries run so far, a prefix of queries_
+    mutable std::vector<std::vector<Document>> results_;
+
+    // Runs the batch of queries starting at the first one without results
+    void RunNextQueries() const;
+};
+
+JoinedDocuments ProcessQueriesJoined(
+    const SearchServer& search_server,
+    const std::vector<std::string>& queries);
@@ -0,0 +1,181 @@
+#include "query_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+using namespace std;
+
+string_view GetQueryStageName(QueryStage stage) {
+    switch (stage) {
+    case QueryStage::PARSE:
+        return "parse"sv;
+    case QueryStage::MINUS_FILTER:
+        return "minus_filter"sv;
+    case QueryStage::POSTING_SCAN:
+        return "posting_scan"sv;
+    case QueryStage::TOP_K:
+        return "top_k"sv;
+    }
+    return "unknown"sv;
+}
+
+string_view GetQueryCounterName(QueryCounter counter) {
+    switch (counter) {
+    case QueryCounter::TERMS_RESOLVED:
+        return "terms_resolved"sv;
+    case QueryCounter::POSTINGS_VISITED:
+        return "postings_visited"sv;
+    case QueryCounter::DOCUMENTS_SCORED:
+        return "documents_scored"sv;
+    case QueryCounter::RESULTS_DROPPED:
+        return "results_dropped"sv;
+    }
+    return "unknown"sv;
+}
+
+uint64_t QueryTrace::GetStageNanoseconds(QueryStage stage) const {
+    return stage_nanoseconds[static_cast<size_t>(stage)];
+}
+
+uint64_t QueryTrace::GetCounter(QueryCounter counter) const {
+    return counters[static_cast<size_t>(counter)];
+}
+
+uint64_t QueryTrace::GetTotalNanoseconds() const {
+    uint64_t total_nanoseconds = 0;
+    for (uint64_t nanoseconds : stage_nanoseconds) {
+        total_nanoseconds += nanoseconds;
+    }
+    return total_nanoseconds;
+}
+
+ostream& operator<< (ostream& out, const QueryTrace& trace) {
+    out << "{ total_ns = "s << trace.GetTotalNanoseconds();
+    for (size_t stage = 0; stage < QUERY_STAGE_COUNT; ++stage) {
+        out << ", "s << GetQueryStageName(static_cast<QueryStage>(stage)) << "_ns = "s
+            << trace.stage_nanoseconds[stage];
+    }
+    for (size_t counter = 0; counter < QUERY_COUNTER_COUNT; ++counter) {
+        out << ", "s << GetQueryCounterName(static_cast<QueryCounter>(counter)) << " = "s
+            << trace.counters[counter];
+    }
+    out << " }"s;
+    return out;
+}
+
+void RecordingQueryTracer::StartStage(QueryStage stage) {
+    stage_starts_[static_cast<size_t>(stage)] = Clock::now();
+}
+
+void RecordingQueryTracer::FinishStage(QueryStage stage) {
+    const size_t stage_index = static_cast<size_t>(stage);
+    stage_nanoseconds_[stage_index] += static_cast<uint64_t>(
+        chrono::duration_cast<chrono::nanoseconds>(Clock::now() - stage_starts_[stage_index]).count());
+}
+
+void RecordingQueryTracer::Count(QueryCounter counter, uint64_t value) {
+    counters_[static_cast<size_t>(counter)].fetch_add(value, memory_order_relaxed);
+}
+
+QueryTrace RecordingQueryTracer::GetTrace() const {
+    QueryTrace trace;
+    trace.stage_nanoseconds = stage_nanoseconds_;
+    for (size_t counter = 0; counter < QUERY_COUNTER_COUNT; ++counter) {
+        trace.counters[counter] = counters_[counter].load(memory_order_relaxed);
+    }
+    return trace;
+}
+
+void LatencyHistogram::Record(uint64_t value) {
+    bucket_counts_[GetBucketIndex(value)].fetch_add(1, memory_order_relaxed);
+    count_.fetch_add(1, memory_order_relaxed);
+    sum_.fetch_add(value, memory_order_relaxed);
+    uint64_t max = max_.load(memory_order_relaxed);
+    while (max < value && !max_.compare_exchange_weak(max, value, memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::GetCount() const {
+    return count_.load(memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::GetSum() const {
+    return sum_.load(memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::GetMax() const {
+    return max_.load(memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::GetPercentile(double fraction) const {
+    // Buckets are read one by one while others record, so the total is taken
+    // from them rather than from count_
+    array<uint64_t, BUCKET_COUNT> bucket_counts;
+    uint64_t count = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        bucket_counts[i] = bucket_counts_[i].load(memory_order_relaxed);
+        count += bucket_counts[i];
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    const uint64_t rank = max<uint64_t>(1, static_cast<uint64_t>(ceil(clamp(fraction, 0.0, 1.0) * count)));
+    uint64_t seen_count = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen_count += bucket_counts[i];
+        if (seen_count >= rank) {
+            return min(GetBucketUpperBound(i), GetMax());
+        }
+    }
+    return GetMax();
+}
+
+size_t LatencyHistogram::GetBucketIndex(uint64_t value) {
+    if (value < 2 * SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(value);
+    }
+    int highest_bit = 0;
+    for (int shift = 32; shift > 0; shift /= 2) {
+        if (value >> (highest_bit + shift) != 0) {
+            highest_bit += shift;
+        }
+    }
+    // The bits right below the highest one pick the sub-bucket
+    const int sub_bucket_shift = highest_bit - SUB_BUCKET_BITS;
+    return static_cast<size_t>(2 * SUB_BUCKET_COUNT + (highest_bit - SUB_BUCKET_BITS - 1) * SUB_BUCKET_COUNT
+        + ((value >> sub_bucket_shift) & (SUB_BUCKET_COUNT - 1)));
+}
+
+uint64_t LatencyHistogram::GetBucketUpperBound(size_t bucket_index) {
+    if (bucket_index < 2 * SUB_BUCKET_COUNT) {
+        return bucket_index;
+    }
+    const size_t index = bucket_index - 2 * SUB_BUCKET_COUNT;
+    const int sub_bucket_shift = static_cast<int>(index / SUB_BUCKET_COUNT) + 1;
+    const uint64_t lower_bound = (SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT) << sub_bucket_shift;
+    return lower_bound + ((uint64_t{ 1 } << sub_bucket_shift) - 1);
+}
+
+void QueryStats::Record(const QueryTrace& trace) {
+    for (size_t stage = 0; stage < QUERY_STAGE_COUNT; ++stage) {
+        stage_histograms_[stage].Record(trace.stage_nanoseconds[stage]);
+    }
+    total_histogram_.Record(trace.GetTotalNanoseconds());
+    for (size_t counter = 0; counter < QUERY_COUNTER_COUNT; ++counter) {
+        counter_histograms_[counter].Record(trace.counters[counter]);
+    }
+}
+
+const LatencyHistogram& QueryStats::GetStageHistogram(QueryStage stage) const {
+    return stage_histograms_[static_cast<size_t>(stage)];
+}
+
+const LatencyHistogram& QueryStats::GetTotalHistogram() const {
+    return total_histogram_;
+}
+
+const LatencyHistogram& QueryStats::GetCounterHistogram(QueryCounter counter) const {
+    return counter_histograms_[static_cast<size_t>(counter)];
+}
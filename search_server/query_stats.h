@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+// Stages of a search, in the order they run
+enum class QueryStage {
+    PARSE,
+    MINUS_FILTER,
+    POSTING_SCAN,
+    TOP_K,
+};
+
+enum class QueryCounter {
+    TERMS_RESOLVED,
+    POSTINGS_VISITED,
+    DOCUMENTS_SCORED,
+    RESULTS_DROPPED,
+};
+
+constexpr size_t QUERY_STAGE_COUNT = static_cast<size_t>(QueryStage::TOP_K) + 1;
+constexpr size_t QUERY_COUNTER_COUNT = static_cast<size_t>(QueryCounter::RESULTS_DROPPED) + 1;
+
+std::string_view GetQueryStageName(QueryStage stage);
+
+std::string_view GetQueryCounterName(QueryCounter counter);
+
+// Breakdown of a single search
+struct QueryTrace {
+    std::array<uint64_t, QUERY_STAGE_COUNT> stage_nanoseconds{};
+    std::array<uint64_t, QUERY_COUNTER_COUNT> counters{};
+
+    uint64_t GetStageNanoseconds(QueryStage stage) const;
+
+    uint64_t GetCounter(QueryCounter counter) const;
+
+    uint64_t GetTotalNanoseconds() const;
+};
+
+std::ostream& operator<< (std::ostream& out, const QueryTrace& trace);
+
+// Tracers are the compile-time policy of traced searches. This one does
+// nothing, and its empty inline calls leave nothing behind in the search.
+struct NullQueryTracer {
+    void StartStage(QueryStage) {
+    }
+
+    void FinishStage(QueryStage) {
+    }
+
+    void Count(QueryCounter, uint64_t) {
+    }
+};
+
+// Collects the trace of one search. Stages are timed on the searching
+// thread; counters may also be added by the tasks of a parallel search.
+class RecordingQueryTracer {
+public:
+    void StartStage(QueryStage stage);
+
+    void FinishStage(QueryStage stage);
+
+    void Count(QueryCounter counter, uint64_t value);
+
+    QueryTrace GetTrace() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::array<Clock::time_point, QUERY_STAGE_COUNT> stage_starts_{};
+    std::array<uint64_t, QUERY_STAGE_COUNT> stage_nanoseconds_{};
+    std::array<std::atomic<uint64_t>, QUERY_COUNTER_COUNT> counters_{};
+};
+
+// Histogram of non-negative values in log-linear buckets: every power of two
+// is split into SUB_BUCKET_COUNT buckets, so a percentile is within 1/8 of the
+// real value whatever its magnitude. Recording is a few relaxed atomic adds,
+// any number of threads may record and read at once.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr uint64_t SUB_BUCKET_COUNT = uint64_t{ 1 } << SUB_BUCKET_BITS;
+    // Values below 2 * SUB_BUCKET_COUNT get a bucket each
+    static constexpr size_t BUCKET_COUNT = 2 * SUB_BUCKET_COUNT + (63 - SUB_BUCKET_BITS) * SUB_BUCKET_COUNT;
+
+    void Record(uint64_t value);
+
+    uint64_t GetCount() const;
+
+    uint64_t GetSum() const;
+
+    uint64_t GetMax() const;
+
+    // Upper bound of the bucket holding the value at fraction of the
+    // recorded values, 0 if there are none
+    uint64_t GetPercentile(double fraction) const;
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> bucket_counts_{};
+    std::atomic<uint64_t> count_ = 0;
+    std::atomic<uint64_t> sum_ = 0;
+    std::atomic<uint64_t> max_ = 0;
+
+    static size_t GetBucketIndex(uint64_t value);
+
+    static uint64_t GetBucketUpperBound(size_t bucket_index);
+};
+
+// Histograms of the stage timings, the total time and the counters of many
+// searches. Lock-free, so searches of all threads can record into one.
+class QueryStats {
+public:
+    void Record(const QueryTrace& trace);
+
+    const LatencyHistogram& GetStageHistogram(QueryStage stage) const;
+
+    const LatencyHistogram& GetTotalHistogram() const;
+
+    const LatencyHistogram& GetCounterHistogram(QueryCounter counter) const;
+
+private:
+    std::array<LatencyHistogram, QUERY_STAGE_COUNT> stage_histograms_;
+    LatencyHistogram total_histogram_;
+    std::array<LatencyHistogram, QUERY_COUNTER_COUNT> counter_histograms_;
+};
@@ -1,19 +1,19 @@
-#include "read_input_functions.h"
-
-#include <iostream>
-#include <string>
-
-using namespace std;
-
-string ReadLine() {
-    string s;
-    getline(cin, s);
-    return s;
-}
-
-int ReadLineWithNumber() {
-    int result;
-    cin >> result;
-    ReadLine();
-    return result;
-}
+#include "read_input_functions.h"
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+string ReadLine() {
+    string s;
+    getline(cin, s);
+    return s;
+}
+
+int ReadLineWithNumber() {
+    int result;
+    cin >> result;
+    ReadLine();
+    return result;
+}
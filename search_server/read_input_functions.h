@@ -1,7 +1,7 @@
-#pragma once
-
-#include <string>
-
-std::string ReadLine();
-
-int ReadLineWithNumber();
+#pragma once
+
+#include <string>
+
+std::string ReadLine();
+
+int ReadLineWithNumber();
@@ -0,0 +1,26 @@
+#include "relevance_accumulator.h"
+
+#include <algorithm>
+
+using namespace std;
+
+RelevanceAccumulator& RelevanceAccumulator::ForThisThread() {
+    thread_local RelevanceAccumulator accumulator;
+    return accumulator;
+}
+
+void RelevanceAccumulator::BeginQuery(size_t document_count, size_t range_count) {
+    if (relevances_.size() < document_count) {
+        // Grow geometrically so that a corpus growing between queries does not reallocate every time
+        const size_t new_size = max(document_count, relevances_.size() * 2);
+        relevances_.resize(new_size, 0.0);
+        states_.resize(new_size, State::UNTOUCHED);
+    }
+    if (range_buffers_.size() < range_count) {
+        range_buffers_.resize(range_count);
+    }
+    for (size_t range_index = 0; range_index < range_count; ++range_index) {
+        range_buffers_[range_index].touched_ordinals.clear();
+        range_buffers_[range_index].documents.clear();
+    }
+}
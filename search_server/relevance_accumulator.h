@@ -0,0 +1,63 @@
+#pragma once
+
+#include "document.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Relevance table indexed by document ordinal, reused by every query run on
+// the same thread. A query resets only the entries it touched, and nothing is
+// allocated once the table has grown to the corpus size.
+class RelevanceAccumulator {
+public:
+    // Scratch of one range of a scan. Cleared, not freed, by every query, so
+    // it allocates only while a query touches more than any before it.
+    struct RangeBuffers {
+        std::vector<int> touched_ordinals;
+        std::vector<Document> documents;
+    };
+
+    static RelevanceAccumulator& ForThisThread();
+
+    // Makes room for document_count ordinals and empties the buffers of
+    // range_count ranges. Every query resets the entries it touched, so the
+    // table is clean between queries.
+    void BeginQuery(size_t document_count, size_t range_count);
+
+    // Each range has its own buffers, so tasks of different ranges may use
+    // them at the same time
+    RangeBuffers& GetRangeBuffers(size_t range_index) {
+        return range_buffers_[range_index];
+    }
+
+    // Returns true when the ordinal is touched for the first time.
+    // Different threads may add to different ordinals at the same time.
+    bool Add(int ordinal, double relevance) {
+        relevances_[ordinal] += relevance;
+        if (states_[ordinal] == State::UNTOUCHED) {
+            states_[ordinal] = State::SCORED;
+            return true;
+        }
+        return false;
+    }
+
+    double GetRelevance(int ordinal) const {
+        return relevances_[ordinal];
+    }
+
+    void Reset(int ordinal) {
+        relevances_[ordinal] = 0.0;
+        states_[ordinal] = State::UNTOUCHED;
+    }
+
+private:
+    enum class State : uint8_t {
+        UNTOUCHED,
+        SCORED,
+    };
+
+    std::vector<double> relevances_;
+    std::vector<State> states_;
+    std::vector<RangeBuffers> range_buffers_;
+};
@@ -1,27 +1,70 @@
-#include "request_queue.h"
-
-#include "document.h"
-#include "search_server.h"
-
-using namespace std;
-
-RequestQueue::RequestQueue(const SearchServer& search_server) : search_server_(search_server) {
-}
-
-vector<Document> RequestQueue::AddFindRequest(const string& raw_query, DocumentStatus status) {
-    return RequestQueue::AddFindRequest(
-        raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
-            return document_status == status;
-        });
-}
-
-vector<Document> RequestQueue::AddFindRequest(const string& raw_query) {
-    return RequestQueue::AddFindRequest(raw_query, DocumentStatus::ACTUAL);
-}
-
-int RequestQueue::GetNoResultRequests() const {
-    return count_if(requests_.begin(), requests_.end(),
-        [](const QueryResult& item) {
-            return item.query_count == 0;
-        });
-}
\ No newline at end of file
+#include "request_queue.h"
+
+#include "document.h"
+#include "search_server.h"
+
+using namespace std;
+
+RequestQueue::RequestQueue(const SearchServer& search_server, Clock::duration window)
+    : search_server_(search_server), window_(window), requests_(MAX_REQUEST_COUNT) {
+}
+
+vector<Document> RequestQueue::AddFindRequest(string_view raw_query, DocumentStatus status) {
+    return RequestQueue::AddFindRequest(raw_query, DocumentStatusFilter{ status });
+}
+
+vector<Document> RequestQueue::AddFindRequest(string_view raw_query) {
+    return RequestQueue::AddFindRequest(raw_query, DocumentStatus::ACTUAL);
+}
+
+int RequestQueue::GetNoResultRequests() const {
+    TryDropExpired();
+    return no_result_count_.load(memory_order_relaxed);
+}
+
+int RequestQueue::GetRequestCount() const {
+    TryDropExpired();
+    return request_count_.load(memory_order_relaxed);
+}
+
+long long RequestQueue::GetFoundDocumentCount() const {
+    TryDropExpired();
+    return found_document_count_.load(memory_order_relaxed);
+}
+
+void RequestQueue::AddResult(int document_count) {
+    lock_guard guard(mutex_);
+    // Taken under the lock, so every request is at least as new as the ones before it
+    const Clock::time_point add_time = Clock::now();
+    DropExpired(add_time);
+    if (size_ == requests_.size()) {
+        DropOldest();
+    }
+    requests_[(first_ + size_) % requests_.size()] = { add_time, document_count };
+    ++size_;
+    request_count_.fetch_add(1, memory_order_relaxed);
+    no_result_count_.fetch_add(document_count == 0 ? 1 : 0, memory_order_relaxed);
+    found_document_count_.fetch_add(document_count, memory_order_relaxed);
+}
+
+void RequestQueue::DropOldest() const {
+    const QueryResult& oldest = requests_[first_];
+    request_count_.fetch_sub(1, memory_order_relaxed);
+    no_result_count_.fetch_sub(oldest.document_count == 0 ? 1 : 0, memory_order_relaxed);
+    found_document_count_.fetch_sub(oldest.document_count, memory_order_relaxed);
+    first_ = (first_ + 1) % requests_.size();
+    --size_;
+}
+
+void RequestQueue::DropExpired(Clock::time_point now) const {
+    while (size_ > 0 && now - requests_[first_].add_time >= window_) {
+        DropOldest();
+    }
+}
+
+void RequestQueue::TryDropExpired() const {
+    unique_lock lock(mutex_, try_to_lock);
+    if (lock.owns_lock()) {
+        DropExpired(Clock::now());
+    }
+}
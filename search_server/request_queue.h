@@ -1,50 +1,84 @@
-#pragma once
-
-#include "document.h"
-#include "search_server.h"
-
-#include <algorithm>
-#include <stack>
-
-
-class RequestQueue {
-public:
-    explicit RequestQueue(const SearchServer& search_server);
-
-    template <typename DocumentPredicate>
-    std::vector<Document> AddFindRequest(const std::string& raw_query, DocumentPredicate document_predicate);
-
-    std::vector<Document> AddFindRequest(const std::string& raw_query, DocumentStatus status);
-
-    std::vector<Document> AddFindRequest(const std::string& raw_query);
-
-    int GetNoResultRequests() const;
-
-private:
-    struct QueryResult {
-        int add_time = 0;
-        int query_count = 0;
-    };
-    std::deque<QueryResult> requests_;
-    const static int min_in_day_ = 1440;
-
-    const SearchServer& search_server_;
-};
-
-template <typename DocumentPredicate>
-std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query, DocumentPredicate document_predicate) {
-    std::vector <Document> documents = search_server_.SearchServer::FindTopDocuments(raw_query, document_predicate);
-
-    int add_time = static_cast<int>(requests_.size()) + 1;
-    int document_count = static_cast<int>(documents.size());
-
-    if (add_time <= min_in_day_) {
-        requests_.push_front(QueryResult{ add_time, document_count });
-    }
-    else {
-        requests_.pop_back();
-        requests_.push_front(QueryResult{ add_time, document_count });
-    }
-
-    return documents;
-}
+#pragma once
+
+#include "document.h"
+#include "search_server.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// Statistics of the find requests of the last day. A request leaves the
+// window when it is older than the window duration or when
+// MAX_REQUEST_COUNT newer requests have been made, whichever comes first.
+//
+// Requests are kept in a fixed ring buffer and the counters are updated as
+// requests enter and leave it, so recording and reading are O(1) amortized.
+// Several threads may add requests at once: the search itself runs unlocked,
+// only recording takes a short lock, which also stamps the request, so the
+// ring stays in time order. Getters never wait: they read atomic counters and
+// drop expired requests only if the lock is free, otherwise the writer
+// holding it is about to.
+class RequestQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // One request a minute for a day
+    static constexpr int MAX_REQUEST_COUNT = 1440;
+
+    explicit RequestQueue(const SearchServer& search_server, Clock::duration window = std::chrono::hours(24));
+
+    template <typename DocumentPredicate>
+    std::vector<Document> AddFindRequest(std::string_view raw_query, DocumentPredicate document_predicate);
+
+    std::vector<Document> AddFindRequest(std::string_view raw_query, DocumentStatus status);
+
+    std::vector<Document> AddFindRequest(std::string_view raw_query);
+
+    int GetNoResultRequests() const;
+
+    int GetRequestCount() const;
+
+    // Documents found by all requests in the window together
+    long long GetFoundDocumentCount() const;
+
+private:
+    struct QueryResult {
+        Clock::time_point add_time;
+        int document_count = 0;
+    };
+
+    const SearchServer& search_server_;
+    const Clock::duration window_;
+
+    // The window is the size_ requests starting at first_, oldest first.
+    // Reads drop expired requests too, hence mutable. The counters change
+    // only under mutex_, but are read without it.
+    mutable std::mutex mutex_;
+    mutable std::vector<QueryResult> requests_;
+    mutable size_t first_ = 0;
+    mutable size_t size_ = 0;
+    mutable std::atomic<int> request_count_ = 0;
+    mutable std::atomic<int> no_result_count_ = 0;
+    mutable std::atomic<long long> found_document_count_ = 0;
+
+    // Stamps the request with the time it is recorded at
+    void AddResult(int document_count);
+
+    // Expects mutex_ to be held
+    void DropOldest() const;
+
+    // Expects mutex_ to be held
+    void DropExpired(Clock::time_point now) const;
+
+    void TryDropExpired() const;
+};
+
+template <typename DocumentPredicate>
+std::vector<Document> RequestQueue::AddFindRequest(std::string_view raw_query, DocumentPredicate document_predicate) {
+    std::vector<Document> documents = search_server_.FindTopDocuments(raw_query, document_predicate);
+    AddResult(static_cast<int>(documents.size()));
+    return documents;
+}
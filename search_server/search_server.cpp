@@ -1,179 +1,450 @@
-#include "search_server.h"
-
-#include "document.h"
-#include "string_processing.h"
-
-#include<algorithm>
-#include<cmath>
-#include<numeric>
-
-using namespace std;
-
-SearchServer::SearchServer(const string& stop_words)
-    : SearchServer(SplitIntoWords(stop_words)) {
-}
-
-void SearchServer::AddDocument(int document_id, const string& document, DocumentStatus status,
-    const vector<int>& ratings) {
-
-    if (document_id < 0 or
-        documents_.find(document_id) != documents_.end()) {
-        throw invalid_argument("Uncorrect ID of the document");
-    }
-
-
-
-    vector<string> words = (SplitIntoWordsNoStop(document));
-    const double inv_word_count = 1.0 / words.size();
-    for (const string& word : words) {
-        word_to_document_freqs_[word][document_id] += inv_word_count;
-    }
-    documents_.emplace(document_id, DocumentData{ ComputeAverageRating(ratings), status });
-    id_by_order_addition_.push_back(document_id);
-
-}
-
-vector<Document> SearchServer::FindTopDocuments(const string& raw_query, DocumentStatus status) const {
-    return FindTopDocuments(
-        raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
-            return document_status == status;
-        });
-}
-
-vector<Document>  SearchServer::FindTopDocuments(const string& raw_query) const {
-
-    return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
-
-}
-
-
-int SearchServer::GetDocumentCount() const {
-    return static_cast<int>(documents_.size());
-}
-
-int SearchServer::GetDocumentId(int index) const {
-    return id_by_order_addition_.at(index);
-}
-
-tuple<vector<string>, DocumentStatus> SearchServer::MatchDocument(const string& raw_query, int document_id) const {
-
-    Query query = ParseQuery(raw_query);
-    vector<string> matched_words;
-
-    for (const string& word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
-        }
-        if (word_to_document_freqs_.at(word).count(document_id)) {
-            matched_words.push_back(word);
-        }
-    }
-    for (const string& word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
-        }
-        if (word_to_document_freqs_.at(word).count(document_id)) {
-            matched_words.clear();
-            break;
-        }
-    }
-    tuple<vector<string>, DocumentStatus> result = { matched_words, documents_.at(document_id).status };
-    return result;
-
-}
-
-
-
-
-bool SearchServer::IsStopWord(const string& word) const {
-    return stop_words_.count(word) > 0;
-}
-
-bool SearchServer::IsMinusWithOutWord(const string& str) const {
-    return str == "- " or str == "-";
-}
-
-bool SearchServer::IsDoubleMinus(const string& str) const {
-    return str[0] == '-' and str[1] == '-';
-}
-
-bool SearchServer::IsSpecialSymbolInWord(const string& str) const {
-    for (char ch : str) {
-
-        if (ch < ' ' and ch >'\0') {
-            return true;
-        }
-    }
-    return false;
-}
-
-bool SearchServer::CheckQuery(const string& query) const {
-    return !(IsMinusWithOutWord(query) or IsDoubleMinus(query) or IsSpecialSymbolInWord(query));
-}
-
-vector<string> SearchServer::SplitIntoWordsNoStop(const string& text) const {
-
-    vector<string> words;
-
-    for (const string& word : SplitIntoWords(text)) {
-
-        if (IsSpecialSymbolInWord(word)) {
-            throw invalid_argument("Uncorrect content of the query"s);
-        }
-
-        if (!IsStopWord(word)) {
-            words.push_back(word);
-        }
-    }
-    return words;
-}
-
-int SearchServer::ComputeAverageRating(const vector<int>& ratings) {
-    if (ratings.empty()) {
-        return 0;
-    }
-    int rating_sum = accumulate(ratings.begin(), ratings.end(), 0);
-
-    return rating_sum / static_cast<int>(ratings.size());
-}
-
-SearchServer::QueryWord SearchServer::ParseQueryWord(const string& text) const {
-
-    if (!(CheckQuery(text))) {
-        throw invalid_argument("Uncorrect query"s);
-    }
-
-    string temp_text = text;
-
-    bool is_minus = false;
-    // Word shouldn't be empty
-    if (temp_text[0] == '-') {
-        is_minus = true;
-        temp_text = temp_text.substr(1);
-    }
-    return { temp_text, is_minus, IsStopWord(temp_text) };
-}
-
-SearchServer::Query SearchServer::ParseQuery(const string& text) const {
-
-    Query query;
-
-    for (const string& word : SplitIntoWords(text)) {
-
-        const QueryWord query_word = ParseQueryWord(word);
-        if (!query_word.is_stop) {
-            if (query_word.is_minus) {
-                query.minus_words.insert(query_word.data);
-            }
-            else {
-                query.plus_words.insert(query_word.data);
-            }
-        }
-    }
-    return query;
-}
-
-// Existence required
-double SearchServer::ComputeWordInverseDocumentFreq(const string& word) const {
-    return log(GetDocumentCount() * 1.0 / word_to_document_freqs_.at(word).size());
+#include "search_server.h"
+
+#include "document.h"
+#include "snapshot.h"
+#include "string_processing.h"
+
+#include<algorithm>
+#include<atomic>
+#include<cmath>
+#include<numeric>
+#include<stdexcept>
+#include<utility>
+
+using namespace std;
+
+bool IsMoreRelevant(const Document& lhs, const Document& rhs) {
+    if (abs(lhs.relevance - rhs.relevance) < PRECISION) {
+        if (lhs.rating == rhs.rating) {
+            return lhs.id < rhs.id;
+        }
+        return lhs.rating > rhs.rating;
+    }
+    return lhs.relevance > rhs.relevance;
+}
+
+bool DocumentStatusFilter::operator()(int document_id, DocumentStatus document_status, int rating) const {
+    return document_status == status;
+}
+
+SearchServer::SearchServer(const string& stop_words)
+    : SearchServer(string_view(stop_words)) {
+}
+
+SearchServer::SearchServer(string_view stop_words)
+    : SearchServer(SplitIntoWords(stop_words)) {
+}
+
+void SearchServer::AddDocument(int document_id, string_view document, DocumentStatus status,
+    const vector<int>& ratings) {
+
+    CheckDocumentId(document_id);
+    AddTokenizedDocument(document_id, ComputeWordFreqs(document), status, ComputeAverageRating(ratings));
+
+}
+
+void SearchServer::AddDocuments(const vector<DocumentInput>& documents) {
+    AddDocuments(execution::seq, documents);
+}
+
+vector<Document> SearchServer::FindTopDocuments(string_view raw_query, DocumentStatus status,
+    size_t max_result_count) const {
+    return FindTopDocuments(execution::seq, raw_query, status, max_result_count);
+}
+
+vector<Document>  SearchServer::FindTopDocuments(string_view raw_query) const {
+    return FindTopDocuments(execution::seq, raw_query);
+}
+
+PreparedQuery SearchServer::Prepare(string_view raw_query) const {
+    const Query query = ParseQuery(raw_query);
+    PreparedQuery prepared_query;
+    prepared_query.term_count_ = index_.GetTermCount();
+    for (const auto& [words, prepared_words] : { pair{ &query.plus_words, &prepared_query.plus_words_ },
+        pair{ &query.minus_words, &prepared_query.minus_words_ } }) {
+        for (string_view word : *words) {
+            const InvertedIndex::TermId term = index_.FindTerm(word);
+            prepared_words->push_back({ term, string(word) });
+        }
+    }
+    return prepared_query;
+}
+
+vector<Document> SearchServer::FindTopDocuments(const PreparedQuery& query, DocumentStatus status,
+    size_t max_result_count) const {
+    return FindTopDocuments(execution::seq, query, status, max_result_count);
+}
+
+vector<Document> SearchServer::FindTopDocuments(const PreparedQuery& query) const {
+    return FindTopDocuments(execution::seq, query);
+}
+
+QueryTrace SearchServer::Explain(string_view raw_query, DocumentStatus status) const {
+    RecordingQueryTracer tracer;
+    FindTopDocumentsTraced(execution::seq, raw_query, DocumentStatusFilter{ status }, MAX_RESULT_DOCUMENT_COUNT, tracer);
+    return tracer.GetTrace();
+}
+
+
+void SearchServer::RemoveDocument(int document_id) {
+    RemoveDocument(execution::seq, document_id);
+}
+
+int SearchServer::GetRemovedDocumentCount() const {
+    return static_cast<int>(documents_.size() - ordinal_by_id_.size());
+}
+
+void SearchServer::Compact() {
+    Compact(execution::seq);
+}
+
+const map<string_view, double>& SearchServer::GetWordFrequencies(int document_id) const {
+    static const map<string_view, double> empty_word_freqs;
+    const auto ordinal_it = ordinal_by_id_.find(document_id);
+    return ordinal_it == ordinal_by_id_.end() ? empty_word_freqs : index_.GetWordFrequencies(ordinal_it->second);
+}
+
+int SearchServer::GetDocumentCount() const {
+    return static_cast<int>(ordinal_by_id_.size());
+}
+
+int SearchServer::GetDocumentId(int index) const {
+    if (index < 0) {
+        throw out_of_range("Negative document index"s);
+    }
+    return documents_[live_ordinals_.Select(static_cast<size_t>(index))].id;
+}
+
+int SearchServer::GetDocumentFreq(string_view word) const {
+    const InvertedIndex::TermId term = index_.FindTerm(word);
+    return term == InvertedIndex::NO_TERM ? 0 : static_cast<int>(index_.GetDocumentFreq(term));
+}
+
+uint64_t SearchServer::GetGeneration() const {
+    return generation_;
+}
+
+uint64_t SearchServer::TakeGeneration() {
+    static atomic<uint64_t> next_generation = 0;
+    return next_generation.fetch_add(1, memory_order_relaxed);
+}
+
+string SearchServer::NormalizeQuery(string_view raw_query) const {
+    const Query query = ParseQuery(raw_query);
+    string normalized_query;
+    for (string_view word : query.plus_words) {
+        normalized_query.append(word).push_back(' ');
+    }
+    for (string_view word : query.minus_words) {
+        normalized_query.append("-").append(word).push_back(' ');
+    }
+    return normalized_query;
+}
+
+void SearchServer::AddDocumentsFrom(const SearchServer& other, const set<int>& skipped_document_ids) {
+    for (int ordinal = 0; ordinal < static_cast<int>(other.documents_.size()); ++ordinal) {
+        const DocumentData& document_data = other.documents_[ordinal];
+        if (!other.live_ordinals_.Contains(ordinal) || skipped_document_ids.count(document_data.id) > 0) {
+            continue;
+        }
+        CheckDocumentId(document_data.id);
+        AddTokenizedDocument(document_data.id, other.index_.GetWordFrequencies(ordinal), document_data.status,
+            document_data.rating);
+    }
+}
+
+tuple<vector<string_view>, DocumentStatus> SearchServer::MatchDocument(string_view raw_query, int document_id) const {
+    return MatchDocument(execution::seq, raw_query, document_id);
+}
+
+tuple<vector<string_view>, DocumentStatus> SearchServer::MatchDocument(const PreparedQuery& query,
+    int document_id) const {
+    return MatchDocument(execution::seq, query, document_id);
+}
+
+
+
+
+void SearchServer::CompressPostings() {
+    // Results stay the same, so the generation does too
+    index_.Compress();
+}
+
+size_t SearchServer::GetPostingMemoryUsage() const {
+    return index_.GetPostingMemoryUsage();
+}
+
+void SearchServer::SaveSnapshot(const string& path) const {
+    SnapshotWriter writer;
+    writer.Write<uint64_t>(stop_words_.size());
+    for (const string& stop_word : stop_words_) {
+        writer.WriteString(stop_word);
+    }
+    // Written compacted, without the removed documents
+    const vector<int> new_ordinals = ComputeCompactOrdinals();
+    vector<DocumentData> documents;
+    vector<int> document_ids;
+    for (size_t ordinal = 0; ordinal < documents_.size(); ++ordinal) {
+        if (new_ordinals[ordinal] >= 0) {
+            documents.push_back(documents_[ordinal]);
+            document_ids.push_back(documents_[ordinal].id);
+        }
+    }
+    writer.WriteArray(documents);
+    writer.WriteArray(document_ids);
+    index_.SaveTo(writer, new_ordinals);
+    writer.SaveToFile(path);
+}
+
+SearchServer SearchServer::LoadSnapshot(const string& path) {
+    SnapshotReader reader = SnapshotReader::LoadFromFile(path);
+    SearchServer search_server;
+    const uint64_t stop_word_count = reader.Read<uint64_t>();
+    for (uint64_t i = 0; i < stop_word_count; ++i) {
+        search_server.stop_words_.insert(reader.ReadString());
+    }
+    search_server.documents_ = reader.ReadArray<DocumentData>();
+    for (const DocumentData& document_data : search_server.documents_) {
+        if (static_cast<size_t>(document_data.status) >= InvertedIndex::STATUS_COUNT) {
+            throw runtime_error("Snapshot " + path + " has a document with an unknown status");
+        }
+    }
+    const vector<int> document_ids = reader.ReadArray<int>();
+    search_server.index_ = InvertedIndex::LoadFrom(reader, search_server.documents_.size());
+    if (!reader.AtEnd()) {
+        throw runtime_error("Snapshot " + path + " has trailing data");
+    }
+
+    // Only the documents listed in the order of addition are live, the other
+    // slots may only be left by removed ones. An id added again after its
+    // removal lives in the later slot.
+    map<int, int> ordinal_by_document_id;
+    for (int ordinal = 0; ordinal < static_cast<int>(search_server.documents_.size()); ++ordinal) {
+        ordinal_by_document_id[search_server.documents_[ordinal].id] = ordinal;
+    }
+    vector<bool> is_live(search_server.documents_.size(), false);
+    int previous_ordinal = -1;
+    for (int document_id : document_ids) {
+        const auto it = ordinal_by_document_id.find(document_id);
+        if (it == ordinal_by_document_id.end()) {
+            throw runtime_error("Snapshot " + path + " lists an unknown document");
+        }
+        if (!search_server.ordinal_by_id_.insert(*it).second) {
+            throw runtime_error("Snapshot " + path + " lists a document twice");
+        }
+        if (it->second < previous_ordinal) {
+            throw runtime_error("Snapshot " + path + " lists documents out of their order");
+        }
+        previous_ordinal = it->second;
+        is_live[it->second] = true;
+    }
+    for (size_t ordinal = 0; ordinal < is_live.size(); ++ordinal) {
+        if (!is_live[ordinal] && !search_server.index_.GetWordFrequencies(static_cast<int>(ordinal)).empty()) {
+            throw runtime_error("Snapshot " + path + " has postings of a removed document");
+        }
+    }
+    search_server.live_ordinals_ = LiveOrdinals(is_live);
+    search_server.log_document_count_ = log(static_cast<double>(search_server.GetDocumentCount()));
+    return search_server;
+}
+
+DocumentBitmap SearchServer::BuildMinusDocuments(const QueryTerms& query, const vector<DocumentStatus>& statuses) const {
+    DocumentBitmap minus_documents;
+    for (InvertedIndex::TermId term : query.minus_terms) {
+        for (DocumentStatus status : statuses) {
+            if (index_.IsCompressed()) {
+                const CompressedPostingList& postings = index_.GetCompressedPostings(term, status);
+                if (!postings.empty()) {
+                    minus_documents.UnionWith(DocumentBitmap(postings.GetDocuments()));
+                }
+            }
+            else {
+                const InvertedIndex::PostingList& postings = index_.GetPostings(term, status);
+                if (!postings.empty()) {
+                    minus_documents.UnionWith(DocumentBitmap(postings.documents));
+                }
+            }
+        }
+    }
+    return minus_documents;
+}
+
+bool SearchServer::IsStopWord(string_view word) const {
+    return stop_words_.count(word) > 0;
+}
+
+bool SearchServer::IsMinusWithOutWord(string_view str) const {
+    return str == "- " or str == "-";
+}
+
+bool SearchServer::IsDoubleMinus(string_view str) const {
+    return str.size() > 1 and str[0] == '-' and str[1] == '-';
+}
+
+bool SearchServer::IsSpecialSymbolInWord(string_view str) const {
+    for (char ch : str) {
+
+        if (ch < ' ' and ch >'\0') {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SearchServer::CheckQuery(string_view query) const {
+    return !(IsMinusWithOutWord(query) or IsDoubleMinus(query) or IsSpecialSymbolInWord(query));
+}
+
+vector<string_view> SearchServer::SplitIntoWordsNoStop(string_view text) const {
+
+    vector<string_view> words;
+
+    for (string_view word : SplitIntoWords(text)) {
+
+        if (IsSpecialSymbolInWord(word)) {
+            throw invalid_argument("Uncorrect content of the query"s);
+        }
+
+        if (!IsStopWord(word)) {
+            words.push_back(word);
+        }
+    }
+    return words;
+}
+
+int SearchServer::ComputeAverageRating(const vector<int>& ratings) {
+    if (ratings.empty()) {
+        return 0;
+    }
+    int rating_sum = accumulate(ratings.begin(), ratings.end(), 0);
+
+    return rating_sum / static_cast<int>(ratings.size());
+}
+
+void SearchServer::CheckDocumentId(int document_id) const {
+    if (document_id < 0 or
+        ordinal_by_id_.find(document_id) != ordinal_by_id_.end()) {
+        throw invalid_argument("Uncorrect ID of the document");
+    }
+}
+
+map<string_view, double> SearchServer::ComputeWordFreqs(string_view document) const {
+    const vector<string_view> words = SplitIntoWordsNoStop(document);
+    const double inv_word_count = 1.0 / words.size();
+    map<string_view, double> word_freqs;
+    for (string_view word : words) {
+        word_freqs[word] += inv_word_count;
+    }
+    return word_freqs;
+}
+
+void SearchServer::AddTokenizedDocument(int document_id, map<string_view, double> word_freqs,
+    DocumentStatus status, int rating) {
+    const int ordinal = static_cast<int>(documents_.size());
+    index_.AddDocument(ordinal, status, move(word_freqs));
+    documents_.push_back({ document_id, rating, status });
+    live_ordinals_.PushBack();
+    ordinal_by_id_.emplace(document_id, ordinal);
+    log_document_count_ = log(static_cast<double>(GetDocumentCount()));
+    generation_ = TakeGeneration();
+}
+
+vector<int> SearchServer::ComputeCompactOrdinals() const {
+    vector<int> new_ordinals(documents_.size(), -1);
+    int next_ordinal = 0;
+    for (size_t ordinal = 0; ordinal < documents_.size(); ++ordinal) {
+        if (live_ordinals_.Contains(static_cast<int>(ordinal))) {
+            new_ordinals[ordinal] = next_ordinal++;
+        }
+    }
+    return new_ordinals;
+}
+
+SearchServer::QueryWord SearchServer::ParseQueryWord(string_view text) const {
+
+    if (!(CheckQuery(text))) {
+        throw invalid_argument("Uncorrect query"s);
+    }
+
+    bool is_minus = false;
+    // Word shouldn't be empty
+    if (text[0] == '-') {
+        is_minus = true;
+        text.remove_prefix(1);
+    }
+    return { text, is_minus, IsStopWord(text) };
+}
+
+SearchServer::Query SearchServer::ParseQuery(string_view text) const {
+
+    Query query;
+
+    for (string_view word : SplitIntoWords(text)) {
+
+        const QueryWord query_word = ParseQueryWord(word);
+        if (!query_word.is_stop) {
+            if (query_word.is_minus) {
+                query.minus_words.push_back(query_word.data);
+            }
+            else {
+                query.plus_words.push_back(query_word.data);
+            }
+        }
+    }
+
+    for (vector<string_view>* words : { &query.plus_words, &query.minus_words }) {
+        sort(words->begin(), words->end());
+        words->erase(unique(words->begin(), words->end()), words->end());
+    }
+    return query;
+}
+
+SearchServer::QueryTerms SearchServer::ResolveQuery(const Query& query) const {
+    QueryTerms query_terms;
+    for (const auto& [words, terms] : { pair{ &query.plus_words, &query_terms.plus_terms },
+        pair{ &query.minus_words, &query_terms.minus_terms } }) {
+        for (string_view word : *words) {
+            if (const InvertedIndex::TermId term = index_.FindTerm(word); term != InvertedIndex::NO_TERM) {
+                terms->push_back(term);
+            }
+        }
+    }
+    return query_terms;
+}
+
+SearchServer::QueryTerms SearchServer::ResolveQuery(const PreparedQuery& query) const {
+    // Terms are never removed from the dictionary, so only new terms can
+    // change how the query resolves
+    const bool has_new_terms = index_.GetTermCount() != query.term_count_;
+    QueryTerms query_terms;
+    for (const auto& [words, terms] : { pair{ &query.plus_words_, &query_terms.plus_terms },
+        pair{ &query.minus_words_, &query_terms.minus_terms } }) {
+        for (const PreparedQuery::Word& word : *words) {
+            InvertedIndex::TermId term = word.term;
+            // A copy of the preparing server shares its terms; anything else
+            // would index postings of unrelated or missing terms
+            if (term != InvertedIndex::NO_TERM
+                && (term >= index_.GetTermCount() || index_.GetTerm(term) != word.text)) {
+                throw invalid_argument("Prepared query belongs to another server"s);
+            }
+            if (term == InvertedIndex::NO_TERM && has_new_terms) {
+                term = index_.FindTerm(word.text);
+            }
+            if (term != InvertedIndex::NO_TERM) {
+                terms->push_back(term);
+            }
+        }
+    }
+    return query_terms;
+}
+
+double SearchServer::ComputeWordInverseDocumentFreq(InvertedIndex::TermId term, string_view word,
+    const CorpusStatistics* corpus_statistics) const {
+    if (corpus_statistics == nullptr) {
+        return log_document_count_ - index_.GetLogDocumentFreq(term);
+    }
+    // A bound of at least one keeps the IDF finite, as block bounds need
+    const auto it = corpus_statistics->document_freqs.find(word);
+    const int document_freq = it == corpus_statistics->document_freqs.end() ? 1 : max(it->second, 1);
+    return log(static_cast<double>(corpus_statistics->document_count)) - log(static_cast<double>(document_freq));
 }
\ No newline at end of file
@@ -1,166 +1,1066 @@
-#pragma once
-
-#include "document.h"
-#include "string_processing.h"
-
-#include<map>
-
-const int MAX_RESULT_DOCUMENT_COUNT = 5;
-const double PRECISION = 1e-6;
-
-class SearchServer {
-public:
-
-    template <typename StrContainer>
-    explicit SearchServer(const StrContainer& stop_words);
-
-    explicit SearchServer(const std::string& stop_words);
-
-
-    void AddDocument(int document_id, const std::string& document, DocumentStatus status, const std::vector<int>& ratings);
-
-    template<typename KeyMapper>
-    std::vector<Document> FindTopDocuments(const std::string& raw_query, KeyMapper key_mapper) const;
-
-    std::vector<Document> FindTopDocuments(const std::string& raw_query, DocumentStatus status) const;
-
-    std::vector<Document>  FindTopDocuments(const std::string& raw_query) const;
-
-
-    int GetDocumentCount() const;
-
-    int GetDocumentId(int index) const;
-
-    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(const std::string& raw_query, int document_id) const;
-
-private:
-
-    struct DocumentData {
-        int rating;
-        DocumentStatus status;
-    };
-
-    struct Query {
-        std::set<std::string> plus_words;
-        std::set<std::string> minus_words;
-    };
-
-    std::set<std::string> stop_words_;
-    std::map<std::string, std::map<int, double>> word_to_document_freqs_;
-    std::map<int, DocumentData> documents_;
-    std::vector<int> id_by_order_addition_;
-
-
-    bool IsStopWord(const std::string& word) const;
-
-    bool IsMinusWithOutWord(const std::string& str) const;
-
-    bool IsDoubleMinus(const std::string& str) const;
-
-    bool IsSpecialSymbolInWord(const std::string& str) const;
-
-    template <typename StrContainer>
-    bool IsSpecialSymbolInCollection(const StrContainer& words);
-
-    bool CheckQuery(const std::string& query) const;
-
-    std::vector<std::string> SplitIntoWordsNoStop(const std::string& text) const;
-
-    static int ComputeAverageRating(const std::vector<int>& ratings);
-
-    struct QueryWord {
-        std::string data;
-        bool is_minus;
-        bool is_stop;
-    };
-
-    QueryWord ParseQueryWord(const std::string& text) const;
-
-    Query ParseQuery(const std::string& text) const;
-
-    // Existence required
-    double ComputeWordInverseDocumentFreq(const std::string& word) const;
-
-    template <typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const Query& query, DocumentPredicate document_predicate) const;
-
-};
-
-template <typename StrContainer>
-bool SearchServer::IsSpecialSymbolInCollection(const StrContainer& words) {
-    for (const std::string& word : words) {
-        if (IsSpecialSymbolInWord(word)) {
-            return true;
-        }
-    }
-    return false;
-}
-
-
-template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindAllDocuments(const Query& query,
-    DocumentPredicate document_predicate) const {
-    std::map<int, double> document_to_relevance;
-    for (const std::string& word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
-        }
-        const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-        for (const auto& [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-            const auto& document_data = documents_.at(document_id);
-            if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                document_to_relevance[document_id] += term_freq * inverse_document_freq;
-            }
-        }
-    }
-
-    for (const std::string& word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
-        }
-        for (const auto& [document_id, _] : word_to_document_freqs_.at(word)) {
-            document_to_relevance.erase(document_id);
-        }
-    }
-
-    std::vector<Document> matched_documents;
-    for (const auto& [document_id, relevance] : document_to_relevance) {
-        matched_documents.push_back(
-            { document_id, relevance, documents_.at(document_id).rating });
-    }
-    return matched_documents;
-}
-
-template<typename KeyMapper>
-std::vector<Document> SearchServer::FindTopDocuments(const std::string& raw_query, KeyMapper key_mapper) const {
-
-    Query query = ParseQuery(raw_query);
-    std::vector<Document> matched_documents = FindAllDocuments(query, key_mapper);
-
-    sort(matched_documents.begin(), matched_documents.end(),
-        [](const Document& lhs, const Document& rhs) {
-            if (std::abs(lhs.relevance - rhs.relevance) < PRECISION) {
-                return lhs.rating > rhs.rating;
-            }
-            else {
-                return lhs.relevance > rhs.relevance;
-            }
-        });
-    if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
-        matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
-    }
-
-    return matched_documents;
-
-}
-
-template <typename StrContainer>
-SearchServer::SearchServer(const StrContainer& stop_words)
-    : stop_words_(MakeNonEmptySetOfQueryWords(stop_words)) {
-
-    if (IsSpecialSymbolInCollection(stop_words_)) {
-        using namespace std;
-        throw invalid_argument("Special Symbol is in the collection of stop words"s);
-    }
-
+#pragma once
+
+#include "cancellation.h"
+#include "document.h"
+#include "document_bitmap.h"
+#include "inverted_index.h"
+#include "live_ordinals.h"
+#include "query_stats.h"
+#include "relevance_accumulator.h"
+#include "string_processing.h"
+#include "thread_pool.h"
+
+#include<algorithm>
+#include<array>
+#include<cmath>
+#include<cstdint>
+#include<exception>
+#include<execution>
+#include<limits>
+#include<map>
+#include<set>
+#include<string>
+#include<string_view>
+#include<thread>
+#include<type_traits>
+
+const int MAX_RESULT_DOCUMENT_COUNT = 5;
+const double PRECISION = 1e-6;
+
+// Result order: relevance first (equal within PRECISION), then rating, then id
+bool IsMoreRelevant(const Document& lhs, const Document& rhs);
+
+// Predicate that only looks at the status. Searches recognize it at compile
+// time and read just the postings of documents with that status.
+struct DocumentStatusFilter {
+    DocumentStatus status;
+
+    bool operator()(int document_id, DocumentStatus document_status, int rating) const;
+};
+
+// Document counts of a corpus split across several servers. A search given
+// them scores with the IDF of the whole corpus instead of the server's own.
+struct CorpusStatistics {
+    int document_count = 0;
+    std::map<std::string, int, std::less<>> document_freqs;
+};
+
+// One document of a batch given to SearchServer::AddDocuments
+struct DocumentInput {
+    int document_id;
+    std::string_view document;
+    DocumentStatus status;
+    std::vector<int> ratings;
+};
+
+// Query parsed once by SearchServer::Prepare and run any number of times
+// without parsing it again. Words are kept as term ids of the server's
+// dictionary, so a prepared query is only meaningful to the server that made
+// it and to its copies; other servers throw std::invalid_argument. Words
+// missing from the dictionary are looked up again only once it has grown.
+class PreparedQuery {
+public:
+    PreparedQuery() = default;
+
+private:
+    friend class SearchServer;
+
+    struct Word {
+        InvertedIndex::TermId term;
+        // Checks that the term still means this word on the running server
+        std::string text;
+    };
+
+    // Sorted by word, the order the relevance is summed in
+    std::vector<Word> plus_words_;
+    std::vector<Word> minus_words_;
+    size_t term_count_ = 0;
+};
+
+class SearchServer {
+public:
+
+    template <typename StrContainer>
+    explicit SearchServer(const StrContainer& stop_words);
+
+    explicit SearchServer(const std::string& stop_words);
+
+    explicit SearchServer(std::string_view stop_words);
+
+
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+
+    // Same as calling AddDocument for every document in order, including the
+    // exceptions: documents before an invalid one stay added. A parallel
+    // policy tokenizes the documents and builds their postings concurrently.
+    void AddDocuments(const std::vector<DocumentInput>& documents);
+
+    template<typename ExecutionPolicy>
+    void AddDocuments(ExecutionPolicy&& policy, const std::vector<DocumentInput>& documents);
+
+    template<typename KeyMapper>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, KeyMapper key_mapper,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document>  FindTopDocuments(std::string_view raw_query) const;
+
+    // The policy may also be a ThreadPool: the postings scan is then split
+    // into sub-tasks on its workers, the way std::execution::par splits it
+    template<typename ExecutionPolicy, typename KeyMapper>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, KeyMapper key_mapper,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    template<typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentStatus status,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    template<typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query) const;
+
+    // Validates the query and resolves its words once. Throws like FindTopDocuments.
+    // Searches with a query prepared by an unrelated server throw
+    // std::invalid_argument.
+    PreparedQuery Prepare(std::string_view raw_query) const;
+
+    template<typename KeyMapper>
+    std::vector<Document> FindTopDocuments(const PreparedQuery& query, KeyMapper key_mapper,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(const PreparedQuery& query, DocumentStatus status,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(const PreparedQuery& query) const;
+
+    template<typename ExecutionPolicy, typename KeyMapper>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, const PreparedQuery& query, KeyMapper key_mapper,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    template<typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, const PreparedQuery& query, DocumentStatus status,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    template<typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, const PreparedQuery& query) const;
+
+    // Same as FindTopDocuments, reporting the time of every stage and the work
+    // done to the tracer. Every FindTopDocuments overload is one of these with
+    // NullQueryTracer, so the tracer is a compile-time policy that costs an
+    // untraced search nothing. InstrumentedSearchServer records them all.
+    template<typename ExecutionPolicy, typename KeyMapper, typename QueryTracer>
+    std::vector<Document> FindTopDocumentsTraced(ExecutionPolicy&& policy, std::string_view raw_query,
+        KeyMapper key_mapper, size_t max_result_count, QueryTracer& tracer) const;
+
+    // Resolving the prepared words counts as parsing
+    template<typename ExecutionPolicy, typename KeyMapper, typename QueryTracer>
+    std::vector<Document> FindTopDocumentsTraced(ExecutionPolicy&& policy, const PreparedQuery& query,
+        KeyMapper key_mapper, size_t max_result_count, QueryTracer& tracer) const;
+
+    template<typename ExecutionPolicy, typename KeyMapper, typename QueryTracer>
+    std::vector<Document> FindTopDocumentsTraced(ExecutionPolicy&& policy, std::string_view raw_query,
+        KeyMapper key_mapper, size_t max_result_count, const CancellationToken& cancellation_token,
+        QueryTracer& tracer) const;
+
+    template<typename ExecutionPolicy, typename KeyMapper, typename QueryTracer>
+    std::vector<Document> FindTopDocumentsTraced(ExecutionPolicy&& policy, std::string_view raw_query,
+        KeyMapper key_mapper, size_t max_result_count, const CorpusStatistics& corpus_statistics,
+        QueryTracer& tracer) const;
+
+    // Runs a sequential search and returns where its time went
+    QueryTrace Explain(std::string_view raw_query, DocumentStatus status = DocumentStatus::ACTUAL) const;
+
+    // Throws OperationCancelled once the token is cancelled. The scan checks
+    // it every posting block, so even a query over long postings stops soon.
+    template<typename ExecutionPolicy, typename KeyMapper>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, KeyMapper key_mapper,
+        size_t max_result_count, const CancellationToken& cancellation_token) const;
+
+    // Words missing from corpus_statistics are scored as if they occurred in
+    // one document
+    template<typename ExecutionPolicy, typename KeyMapper>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, KeyMapper key_mapper,
+        size_t max_result_count, const CorpusStatistics& corpus_statistics) const;
+
+
+    // Only marks the document removed and updates the document frequencies
+    // of its words, whatever the policy
+    void RemoveDocument(int document_id);
+
+    template<typename ExecutionPolicy>
+    void RemoveDocument(ExecutionPolicy&& policy, int document_id);
+
+    // Removed documents whose slots and postings are still kept. Searches
+    // skip them, but still pay for them, until Compact.
+    int GetRemovedDocumentCount() const;
+
+    // Drops the slots and postings of removed documents in one pass over the
+    // index. RemoveDocument never does it, so the owner picks the moment,
+    // say once the removed documents outnumber the live ones. Results and
+    // the generation stay the same.
+    void Compact();
+
+    template<typename ExecutionPolicy>
+    void Compact(ExecutionPolicy&& policy);
+
+    const std::map<std::string_view, double>& GetWordFrequencies(int document_id) const;
+
+    int GetDocumentCount() const;
+
+    int GetDocumentId(int index) const;
+
+    // Number of documents containing the word
+    int GetDocumentFreq(std::string_view word) const;
+
+    // Changes with every added or removed document, so a result computed at
+    // one generation is still exact while the generation is unchanged.
+    // Generations come from one process-wide counter: servers with different
+    // contents never share one, even after assignment or loading a snapshot.
+    uint64_t GetGeneration() const;
+
+    // Canonical form of the query: plus words, then minus words with their
+    // minus, each group sorted and without duplicates or stop words. Queries
+    // with the same form have the same results. Throws like FindTopDocuments.
+    std::string NormalizeQuery(std::string_view raw_query) const;
+
+    // Copies the documents of other in their order of addition, except the
+    // skipped ones, without tokenizing them again. Stop words are not copied:
+    // both servers are expected to share them. Throws like AddDocument for
+    // ids already in use.
+    void AddDocumentsFrom(const SearchServer& other, const std::set<int>& skipped_document_ids);
+
+    // Plus words of the query found in the document, or none if it contains a
+    // minus word. The words point into the dictionary and stay valid for the
+    // lifetime of the server.
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view raw_query,
+        int document_id) const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(const PreparedQuery& query,
+        int document_id) const;
+
+    // A parallel policy looks the words up concurrently
+    template<typename ExecutionPolicy>
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(ExecutionPolicy&& policy,
+        std::string_view raw_query, int document_id) const;
+
+    template<typename ExecutionPolicy>
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(ExecutionPolicy&& policy,
+        const PreparedQuery& query, int document_id) const;
+
+    // Opt-in for a corpus that is done loading: keeps the postings block
+    // compressed, which saves memory for some search time. Results do not
+    // change. Adding a document decompresses them again; removing one and
+    // snapshots keep the current form, a loaded snapshot is uncompressed.
+    void CompressPostings();
+
+    // Bytes held by the posting lists
+    size_t GetPostingMemoryUsage() const;
+
+    // Writes stop words, documents and the index to a binary file, so a
+    // restart can skip tokenizing. Throws std::runtime_error on IO errors.
+    void SaveSnapshot(const std::string& path) const;
+
+    // Throws std::runtime_error if the file is missing, corrupted or written
+    // by another snapshot version
+    static SearchServer LoadSnapshot(const std::string& path);
+
+private:
+
+    struct DocumentData {
+        int id;
+        int rating;
+        DocumentStatus status;
+    };
+
+    // Words point into the raw query, so a Query must not outlive it.
+    // Both vectors are sorted and contain no duplicates.
+    struct Query {
+        std::vector<std::string_view> plus_words;
+        std::vector<std::string_view> minus_words;
+    };
+
+    std::set<std::string, std::less<>> stop_words_;
+    // The index and documents_ address documents by ordinal, their position in
+    // the order of addition. A removed document keeps its slot in documents_
+    // and its postings until Compact renumbers the live ones, so searches
+    // check live_ordinals_ for every posting.
+    InvertedIndex index_;
+    std::vector<DocumentData> documents_;
+    LiveOrdinals live_ordinals_;
+    std::map<int, int> ordinal_by_id_;
+    // IDF is log(N) - log(df): this is the first half, the second one lives
+    // in every posting list, so neither is recomputed by queries
+    double log_document_count_ = -std::numeric_limits<double>::infinity();
+    uint64_t generation_ = TakeGeneration();
+
+    // Used by LoadSnapshot, which fills every member itself
+    SearchServer() = default;
+
+    // Next value of the process-wide generation counter
+    static uint64_t TakeGeneration();
+
+    bool IsStopWord(std::string_view word) const;
+
+    bool IsMinusWithOutWord(std::string_view str) const;
+
+    bool IsDoubleMinus(std::string_view str) const;
+
+    bool IsSpecialSymbolInWord(std::string_view str) const;
+
+    template <typename StrContainer>
+    bool IsSpecialSymbolInCollection(const StrContainer& words);
+
+    bool CheckQuery(std::string_view query) const;
+
+    std::vector<std::string_view> SplitIntoWordsNoStop(std::string_view text) const;
+
+    static int ComputeAverageRating(const std::vector<int>& ratings);
+
+    // Throws for a negative id or one that is already in use
+    void CheckDocumentId(int document_id) const;
+
+    // Keys point into the document. Touches no state, so documents can be
+    // tokenized concurrently.
+    std::map<std::string_view, double> ComputeWordFreqs(std::string_view document) const;
+
+    void AddTokenizedDocument(int document_id, std::map<std::string_view, double> word_freqs,
+        DocumentStatus status, int rating);
+
+    // New ordinal of every ordinal: live ones are numbered densely in their
+    // order, removed ones get -1
+    std::vector<int> ComputeCompactOrdinals() const;
+
+    struct QueryWord {
+        std::string_view data;
+        bool is_minus;
+        bool is_stop;
+    };
+
+    QueryWord ParseQueryWord(std::string_view text) const;
+
+    Query ParseQuery(std::string_view text) const;
+
+    // Query with its words resolved to terms, each vector in word order.
+    // Words missing from the dictionary are left out.
+    struct QueryTerms {
+        std::vector<InvertedIndex::TermId> plus_terms;
+        std::vector<InvertedIndex::TermId> minus_terms;
+    };
+
+    QueryTerms ResolveQuery(const Query& query) const;
+
+    QueryTerms ResolveQuery(const PreparedQuery& query) const;
+
+    // Minus words are checked first, so an excluded document costs no plus lookups
+    template<typename ExecutionPolicy>
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchTerms(ExecutionPolicy&& policy,
+        const QueryTerms& query, int document_id) const;
+
+    // The server's own IDF unless corpus_statistics is given
+    double ComputeWordInverseDocumentFreq(InvertedIndex::TermId term, std::string_view word,
+        const CorpusStatistics* corpus_statistics) const;
+
+    // Postings of the form the index is in: InvertedIndex::PostingList or
+    // CompressedPostingList
+    template <typename Postings>
+    const Postings& GetPostings(InvertedIndex::TermId term, DocumentStatus status) const;
+
+    // Documents of the given statuses that contain a minus word of the query
+    DocumentBitmap BuildMinusDocuments(const QueryTerms& query, const std::vector<DocumentStatus>& statuses) const;
+
+    // Posting partitions a search with this predicate has to read
+    template <typename DocumentPredicate>
+    static std::vector<DocumentStatus> GetStatusesToScan(const DocumentPredicate& document_predicate);
+
+    // Status filters are already applied by the choice of partitions
+    template <typename DocumentPredicate>
+    static bool IsAccepted(const DocumentPredicate& document_predicate, const DocumentData& document_data);
+
+    // Block-max MaxScore: walks the postings document by document and skips
+    // documents whose score bound cannot reach the current top, so common
+    // words are barely scanned once the top is filled. Returns exactly what
+    // exhaustive scoring followed by a sort would.
+    // The search is not cancellable without a cancellation_token.
+    // Both scans below read the postings through their cursors, so they are
+    // instantiated for either form of the index.
+    template<typename ExecutionPolicy, typename KeyMapper, typename QueryTracer>
+    std::vector<Document> SearchTopDocuments(ExecutionPolicy&& policy, const QueryTerms& query, KeyMapper key_mapper,
+        size_t max_result_count, const CorpusStatistics* corpus_statistics,
+        const CancellationToken* cancellation_token, QueryTracer& tracer) const;
+
+    // Parses the query as the PARSE stage of the search
+    template<typename ExecutionPolicy, typename KeyMapper, typename QueryTracer>
+    std::vector<Document> SearchRawQuery(ExecutionPolicy&& policy, std::string_view raw_query, KeyMapper key_mapper,
+        size_t max_result_count, const CorpusStatistics* corpus_statistics,
+        const CancellationToken* cancellation_token, QueryTracer& tracer) const;
+
+    template <typename Postings, typename DocumentPredicate, typename QueryTracer>
+    std::vector<Document> FindTopDocumentsMaxScore(const QueryTerms& query, DocumentPredicate document_predicate,
+        size_t max_result_count, const CorpusStatistics* corpus_statistics,
+        const CancellationToken* cancellation_token, QueryTracer& tracer) const;
+
+    // Splits the ordinals into ranges and scores each range on its own thread.
+    // Every range still visits the plus words in query order, so relevance sums are
+    // bit-identical to the sequential version.
+    // Tasks must not throw under std::execution::par: a cancelled range just
+    // stops, and the cancellation is thrown once all of them are done.
+    template <typename Postings, typename ExecutionPolicy, typename DocumentPredicate, typename QueryTracer>
+    std::vector<Document> FindAllDocuments(ExecutionPolicy&& policy, const QueryTerms& query,
+        DocumentPredicate document_predicate, const CorpusStatistics* corpus_statistics,
+        const CancellationToken* cancellation_token, QueryTracer& tracer) const;
+
+    // Only the first max_result_count places are ordered, the rest is dropped unsorted
+    template <typename ExecutionPolicy>
+    static void SelectTopDocuments(ExecutionPolicy&& policy, std::vector<Document>& documents, size_t max_result_count);
+
+    // Calls task(range_index) for every range index on the threads of the policy
+    template <typename Task>
+    static void ForEachRange(const std::execution::parallel_policy&, int range_count, Task task);
+
+    template <typename Task>
+    static void ForEachRange(ThreadPool& thread_pool, int range_count, Task task);
+
+};
+
+template <typename StrContainer>
+bool SearchServer::IsSpecialSymbolInCollection(const StrContainer& words) {
+    for (std::string_view word : words) {
+        if (IsSpecialSymbolInWord(word)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+template <typename DocumentPredicate>
+std::vector<DocumentStatus> SearchServer::GetStatusesToScan(const DocumentPredicate& document_predicate) {
+    if constexpr (std::is_same_v<DocumentPredicate, DocumentStatusFilter>) {
+        return { document_predicate.status };
+    }
+    else {
+        std::vector<DocumentStatus> statuses;
+        for (size_t status = 0; status < InvertedIndex::STATUS_COUNT; ++status) {
+            statuses.push_back(static_cast<DocumentStatus>(status));
+        }
+        return statuses;
+    }
+}
+
+template <typename Postings>
+const Postings& SearchServer::GetPostings(InvertedIndex::TermId term, DocumentStatus status) const {
+    if constexpr (std::is_same_v<Postings, CompressedPostingList>) {
+        return index_.GetCompressedPostings(term, status);
+    }
+    else {
+        return index_.GetPostings(term, status);
+    }
+}
+
+template <typename DocumentPredicate>
+bool SearchServer::IsAccepted(const DocumentPredicate& document_predicate, const DocumentData& document_data) {
+    if constexpr (std::is_same_v<DocumentPredicate, DocumentStatusFilter>) {
+        return true;
+    }
+    else {
+        return document_predicate(document_data.id, document_data.status, document_data.rating);
+    }
+}
+
+template <typename Postings, typename DocumentPredicate, typename QueryTracer>
+std::vector<Document> SearchServer::FindTopDocumentsMaxScore(const QueryTerms& query,
+    DocumentPredicate document_predicate, size_t max_result_count, const CorpusStatistics* corpus_statistics,
+    const CancellationToken* cancellation_token, QueryTracer& tracer) const {
+    if (max_result_count == 0) {
+        return {};
+    }
+
+    struct TermCursor {
+        typename Postings::Cursor postings;
+        double inverse_document_freq;
+        double upper_bound;
+        size_t query_index;
+
+        bool AtEnd() const {
+            return postings.AtEnd();
+        }
+
+        int GetDocument() const {
+            return postings.GetDocument();
+        }
+
+        double GetContribution() const {
+            return postings.GetTermFreq() * inverse_document_freq;
+        }
+
+        // Largest possible contribution of the block the cursor is in
+        double GetBlockUpperBound() const {
+            return postings.GetBlockMaxTermFreq() * inverse_document_freq;
+        }
+    };
+
+    // There is a cursor per plus word and scanned status. query_index keeps the
+    // query order of words: relevance must be summed in that order to be
+    // bit-identical to the exhaustive path. A document lives in one partition,
+    // so at most one cursor of a word can stand on it.
+    const std::vector<DocumentStatus> statuses = GetStatusesToScan(document_predicate);
+    std::vector<TermCursor> cursors;
+    size_t query_term_count = 0;
+    for (InvertedIndex::TermId term : query.plus_terms) {
+        if (index_.GetDocumentFreq(term) == 0) {
+            continue;
+        }
+        const double inverse_document_freq = ComputeWordInverseDocumentFreq(term, index_.GetTerm(term), corpus_statistics);
+        for (DocumentStatus status : statuses) {
+            const Postings& postings = GetPostings<Postings>(term, status);
+            if (!postings.empty()) {
+                cursors.push_back({ postings.begin(), inverse_document_freq,
+                    postings.GetMaxTermFreq() * inverse_document_freq, query_term_count });
+            }
+        }
+        ++query_term_count;
+    }
+    // Built before the scan, so excluded documents are never scored
+    tracer.StartStage(QueryStage::MINUS_FILTER);
+    const DocumentBitmap minus_documents = BuildMinusDocuments(query, statuses);
+    tracer.FinishStage(QueryStage::MINUS_FILTER);
+
+    tracer.StartStage(QueryStage::POSTING_SCAN);
+    // Counted locally, so an empty tracer leaves no work in the loop
+    uint64_t visited_posting_count = 0;
+    uint64_t scored_document_count = 0;
+
+    // by_bound[0, first_essential) are the non-essential terms: even all together
+    // they cannot lift a document into the top, so they never produce candidates
+    std::vector<TermCursor*> by_bound;
+    for (TermCursor& cursor : cursors) {
+        by_bound.push_back(&cursor);
+    }
+    std::stable_sort(by_bound.begin(), by_bound.end(),
+        [](const TermCursor* lhs, const TermCursor* rhs) {
+            return lhs->upper_bound < rhs->upper_bound;
+        });
+    std::vector<double> non_essential_bounds(by_bound.size() + 1, 0.0);
+    for (size_t i = 0; i < by_bound.size(); ++i) {
+        non_essential_bounds[i + 1] = non_essential_bounds[i] + by_bound[i]->upper_bound;
+    }
+    size_t first_essential = 0;
+
+    // Worst of the current top sits in front. Anything scoring below threshold
+    // loses to it even after the PRECISION tie rule; the extra PRECISION covers
+    // rounding of the bounds, which are summed in a different order.
+    std::vector<Document> top_documents;
+    double threshold = -std::numeric_limits<double>::infinity();
+
+    std::vector<double> contributions(query_term_count);
+    std::vector<bool> is_present(query_term_count);
+    size_t candidate_count = 0;
+
+    while (true) {
+        // Every candidate advances at least one cursor, so this is at most once a block
+        if (cancellation_token != nullptr && ++candidate_count % InvertedIndex::PostingList::BLOCK_SIZE == 0) {
+            cancellation_token->ThrowIfCancelled();
+        }
+
+        int document = std::numeric_limits<int>::max();
+        for (size_t i = first_essential; i < by_bound.size(); ++i) {
+            if (!by_bound[i]->AtEnd()) {
+                document = std::min(document, by_bound[i]->GetDocument());
+            }
+        }
+        if (document == std::numeric_limits<int>::max()) {
+            break;
+        }
+
+        const bool is_excluded = minus_documents.Contains(document);
+        std::fill(is_present.begin(), is_present.end(), false);
+        double score_bound = non_essential_bounds[first_essential];
+        for (size_t i = first_essential; i < by_bound.size(); ++i) {
+            TermCursor& cursor = *by_bound[i];
+            if (!cursor.AtEnd() && cursor.GetDocument() == document) {
+                ++visited_posting_count;
+                if (!is_excluded) {
+                    contributions[cursor.query_index] = cursor.GetContribution();
+                    is_present[cursor.query_index] = true;
+                    score_bound += contributions[cursor.query_index];
+                }
+                cursor.postings.Next();
+            }
+        }
+        if (is_excluded || score_bound < threshold) {
+            continue;
+        }
+
+        const DocumentData& document_data = documents_[document];
+        if (!live_ordinals_.Contains(document) || !IsAccepted(document_predicate, document_data)) {
+            continue;
+        }
+
+        // Replace the bounds of non-essential terms with real contributions,
+        // most promising first, until the document is out of the running
+        for (size_t i = first_essential; i-- > 0 && score_bound >= threshold;) {
+            TermCursor& cursor = *by_bound[i];
+            score_bound -= cursor.upper_bound;
+            cursor.postings.SkipTo(document);
+            if (cursor.AtEnd() || score_bound + cursor.GetBlockUpperBound() < threshold) {
+                continue;
+            }
+            ++visited_posting_count;
+            if (cursor.GetDocument() == document) {
+                contributions[cursor.query_index] = cursor.GetContribution();
+                is_present[cursor.query_index] = true;
+                score_bound += contributions[cursor.query_index];
+            }
+        }
+        if (score_bound < threshold) {
+            continue;
+        }
+
+        double relevance = 0.0;
+        for (size_t i = 0; i < query_term_count; ++i) {
+            if (is_present[i]) {
+                relevance += contributions[i];
+            }
+        }
+        ++scored_document_count;
+
+        const Document candidate(document_data.id, relevance, document_data.rating);
+        if (top_documents.size() < max_result_count) {
+            top_documents.push_back(candidate);
+            std::push_heap(top_documents.begin(), top_documents.end(), IsMoreRelevant);
+        }
+        else if (IsMoreRelevant(candidate, top_documents.front())) {
+            std::pop_heap(top_documents.begin(), top_documents.end(), IsMoreRelevant);
+            top_documents.back() = candidate;
+            std::push_heap(top_documents.begin(), top_documents.end(), IsMoreRelevant);
+        }
+        else {
+            continue;
+        }
+
+        if (top_documents.size() == max_result_count) {
+            threshold = top_documents.front().relevance - 2 * PRECISION;
+            while (first_essential < by_bound.size() && non_essential_bounds[first_essential + 1] < threshold) {
+                ++first_essential;
+            }
+        }
+    }
+
+    tracer.FinishStage(QueryStage::POSTING_SCAN);
+    tracer.Count(QueryCounter::POSTINGS_VISITED, visited_posting_count);
+    tracer.Count(QueryCounter::DOCUMENTS_SCORED, scored_document_count);
+    tracer.Count(QueryCounter::RESULTS_DROPPED, scored_document_count - top_documents.size());
+
+    tracer.StartStage(QueryStage::TOP_K);
+    std::sort_heap(top_documents.begin(), top_documents.end(), IsMoreRelevant);
+    tracer.FinishStage(QueryStage::TOP_K);
+    return top_documents;
+}
+
+template <typename ExecutionPolicy>
+void SearchServer::SelectTopDocuments(ExecutionPolicy&& policy, std::vector<Document>& documents,
+    size_t max_result_count) {
+    if (documents.size() > max_result_count) {
+        std::partial_sort(policy, documents.begin(), documents.begin() + max_result_count, documents.end(),
+            IsMoreRelevant);
+        documents.resize(max_result_count);
+    }
+    else {
+        std::sort(policy, documents.begin(), documents.end(), IsMoreRelevant);
+    }
+}
+
+template <typename Task>
+void SearchServer::ForEachRange(const std::execution::parallel_policy&, int range_count, Task task) {
+    std::vector<int> range_indexes(range_count);
+    for (int i = 0; i < range_count; ++i) {
+        range_indexes[i] = i;
+    }
+    std::for_each(std::execution::par, range_indexes.begin(), range_indexes.end(), task);
+}
+
+template <typename Task>
+void SearchServer::ForEachRange(ThreadPool& thread_pool, int range_count, Task task) {
+    thread_pool.ParallelFor(static_cast<size_t>(range_count), [&task](size_t range_index) {
+        task(static_cast<int>(range_index));
+    });
+}
+
+template <typename Postings, typename ExecutionPolicy, typename DocumentPredicate, typename QueryTracer>
+std::vector<Document> SearchServer::FindAllDocuments(ExecutionPolicy&& policy, const QueryTerms& query,
+    DocumentPredicate document_predicate, const CorpusStatistics* corpus_statistics,
+    const CancellationToken* cancellation_token, QueryTracer& tracer) const {
+    if (documents_.empty()) {
+        return {};
+    }
+
+    // Partitions of a word are disjoint, so each document still gets its
+    // contributions in query order
+    const std::vector<DocumentStatus> statuses = GetStatusesToScan(document_predicate);
+    std::vector<std::pair<const Postings*, double>> plus_terms;
+    for (InvertedIndex::TermId term : query.plus_terms) {
+        // Only postings of removed documents are left
+        if (index_.GetDocumentFreq(term) == 0) {
+            continue;
+        }
+        const double inverse_document_freq = ComputeWordInverseDocumentFreq(term, index_.GetTerm(term), corpus_statistics);
+        for (DocumentStatus status : statuses) {
+            plus_terms.emplace_back(&GetPostings<Postings>(term, status), inverse_document_freq);
+        }
+    }
+    // Read-only during the scan, so all tasks share it
+    tracer.StartStage(QueryStage::MINUS_FILTER);
+    const DocumentBitmap minus_documents = BuildMinusDocuments(query, statuses);
+    tracer.FinishStage(QueryStage::MINUS_FILTER);
+
+    tracer.StartStage(QueryStage::POSTING_SCAN);
+
+    const int ordinal_count = static_cast<int>(documents_.size());
+    const int range_count = std::min<int>(ordinal_count, std::max(1u, std::thread::hardware_concurrency()) * 4);
+    const int range_size = ordinal_count / range_count + 1;
+
+    // Ranges are disjoint, so the tasks share the accumulator without locks.
+    // Each task resets the entries it touched, leaving the table clean.
+    RelevanceAccumulator& accumulator = RelevanceAccumulator::ForThisThread();
+    accumulator.BeginQuery(documents_.size(), range_count);
+    ForEachRange(policy, range_count,
+        [&](int range_index) {
+            // Ranges started after the cancellation do nothing
+            if (cancellation_token != nullptr && cancellation_token->IsCancelled()) {
+                return;
+            }
+            const int range_begin = range_size * range_index;
+            const int range_end = range_begin + range_size;
+            RelevanceAccumulator::RangeBuffers& buffers = accumulator.GetRangeBuffers(range_index);
+            uint64_t visited_posting_count = 0;
+            bool is_cancelled = false;
+
+            for (const auto& [plus_postings, inverse_document_freq] : plus_terms) {
+                auto cursor = plus_postings->begin();
+                cursor.SkipTo(range_begin);
+                for (size_t i = 0; !cursor.AtEnd() && cursor.GetDocument() < range_end; cursor.Next(), ++i) {
+                    if (i % InvertedIndex::PostingList::BLOCK_SIZE == 0 && cancellation_token != nullptr
+                        && cancellation_token->IsCancelled()) {
+                        is_cancelled = true;
+                        break;
+                    }
+                    ++visited_posting_count;
+                    const int ordinal = cursor.GetDocument();
+                    if (!minus_documents.Contains(ordinal) && live_ordinals_.Contains(ordinal)
+                        && IsAccepted(document_predicate, documents_[ordinal])
+                        && accumulator.Add(ordinal, cursor.GetTermFreq() * inverse_document_freq)) {
+                        buffers.touched_ordinals.push_back(ordinal);
+                    }
+                }
+                if (is_cancelled) {
+                    break;
+                }
+            }
+
+            // Scores are reset even when cancelled, the accumulator is reused
+            for (int ordinal : buffers.touched_ordinals) {
+                const DocumentData& document_data = documents_[ordinal];
+                buffers.documents.push_back({ document_data.id, accumulator.GetRelevance(ordinal), document_data.rating });
+                accumulator.Reset(ordinal);
+            }
+            tracer.Count(QueryCounter::POSTINGS_VISITED, visited_posting_count);
+            tracer.Count(QueryCounter::DOCUMENTS_SCORED, buffers.touched_ordinals.size());
+        });
+    if (cancellation_token != nullptr) {
+        cancellation_token->ThrowIfCancelled();
+    }
+
+    // Only the result is allocated
+    size_t matched_document_count = 0;
+    for (int range_index = 0; range_index < range_count; ++range_index) {
+        matched_document_count += accumulator.GetRangeBuffers(range_index).documents.size();
+    }
+    std::vector<Document> matched_documents;
+    matched_documents.reserve(matched_document_count);
+    for (int range_index = 0; range_index < range_count; ++range_index) {
+        const std::vector<Document>& documents = accumulator.GetRangeBuffers(range_index).documents;
+        matched_documents.insert(matched_documents.end(), documents.begin(), documents.end());
+    }
+    tracer.FinishStage(QueryStage::POSTING_SCAN);
+    return matched_documents;
+}
+
+template<typename KeyMapper>
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, KeyMapper key_mapper,
+    size_t max_result_count) const {
+    return FindTopDocuments(std::execution::seq, raw_query, key_mapper, max_result_count);
+}
+
+template<typename ExecutionPolicy, typename KeyMapper>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+    KeyMapper key_mapper, size_t max_result_count) const {
+    NullQueryTracer tracer;
+    return FindTopDocumentsTraced(policy, raw_query, key_mapper, max_result_count, tracer);
+}
+
+template<typename ExecutionPolicy, typename KeyMapper>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+    KeyMapper key_mapper, size_t max_result_count, const CorpusStatistics& corpus_statistics) const {
+    NullQueryTracer tracer;
+    return FindTopDocumentsTraced(policy, raw_query, key_mapper, max_result_count, corpus_statistics, tracer);
+}
+
+template<typename ExecutionPolicy, typename KeyMapper>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+    KeyMapper key_mapper, size_t max_result_count, const CancellationToken& cancellation_token) const {
+    NullQueryTracer tracer;
+    return FindTopDocumentsTraced(policy, raw_query, key_mapper, max_result_count, cancellation_token, tracer);
+}
+
+template<typename ExecutionPolicy, typename KeyMapper, typename QueryTracer>
+std::vector<Document> SearchServer::SearchTopDocuments(ExecutionPolicy&& policy, const QueryTerms& query,
+    KeyMapper key_mapper, size_t max_result_count, const CorpusStatistics* corpus_statistics,
+    const CancellationToken* cancellation_token, QueryTracer& tracer) const {
+
+    if constexpr (std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>) {
+        if (index_.IsCompressed()) {
+            return FindTopDocumentsMaxScore<CompressedPostingList>(query, key_mapper, max_result_count,
+                corpus_statistics, cancellation_token, tracer);
+        }
+        return FindTopDocumentsMaxScore<InvertedIndex::PostingList>(query, key_mapper, max_result_count,
+            corpus_statistics, cancellation_token, tracer);
+    }
+    else {
+        std::vector<Document> matched_documents = index_.IsCompressed()
+            ? FindAllDocuments<CompressedPostingList>(policy, query, key_mapper, corpus_statistics,
+                cancellation_token, tracer)
+            : FindAllDocuments<InvertedIndex::PostingList>(policy, query, key_mapper, corpus_statistics,
+                cancellation_token, tracer);
+
+        tracer.StartStage(QueryStage::TOP_K);
+        const size_t matched_document_count = matched_documents.size();
+        // A ThreadPool is no execution policy for the standard algorithms
+        if constexpr (std::is_same_v<std::decay_t<ExecutionPolicy>, ThreadPool>) {
+            SelectTopDocuments(std::execution::seq, matched_documents, max_result_count);
+        }
+        else {
+            SelectTopDocuments(policy, matched_documents, max_result_count);
+        }
+        tracer.FinishStage(QueryStage::TOP_K);
+        tracer.Count(QueryCounter::RESULTS_DROPPED, matched_document_count - matched_documents.size());
+
+        return matched_documents;
+    }
+
+}
+
+template<typename ExecutionPolicy, typename KeyMapper, typename QueryTracer>
+std::vector<Document> SearchServer::SearchRawQuery(ExecutionPolicy&& policy, std::string_view raw_query,
+    KeyMapper key_mapper, size_t max_result_count, const CorpusStatistics* corpus_statistics,
+    const CancellationToken* cancellation_token, QueryTracer& tracer) const {
+    tracer.StartStage(QueryStage::PARSE);
+    const QueryTerms query = ResolveQuery(ParseQuery(raw_query));
+    tracer.FinishStage(QueryStage::PARSE);
+    tracer.Count(QueryCounter::TERMS_RESOLVED, query.plus_terms.size() + query.minus_terms.size());
+    return SearchTopDocuments(policy, query, key_mapper, max_result_count, corpus_statistics, cancellation_token,
+        tracer);
+}
+
+template<typename ExecutionPolicy, typename KeyMapper, typename QueryTracer>
+std::vector<Document> SearchServer::FindTopDocumentsTraced(ExecutionPolicy&& policy, std::string_view raw_query,
+    KeyMapper key_mapper, size_t max_result_count, QueryTracer& tracer) const {
+    return SearchRawQuery(policy, raw_query, key_mapper, max_result_count, nullptr, nullptr, tracer);
+}
+
+template<typename ExecutionPolicy, typename KeyMapper, typename QueryTracer>
+std::vector<Document> SearchServer::FindTopDocumentsTraced(ExecutionPolicy&& policy, const PreparedQuery& query,
+    KeyMapper key_mapper, size_t max_result_count, QueryTracer& tracer) const {
+    tracer.StartStage(QueryStage::PARSE);
+    const QueryTerms query_terms = ResolveQuery(query);
+    tracer.FinishStage(QueryStage::PARSE);
+    tracer.Count(QueryCounter::TERMS_RESOLVED, query_terms.plus_terms.size() + query_terms.minus_terms.size());
+    return SearchTopDocuments(policy, query_terms, key_mapper, max_result_count, nullptr, nullptr, tracer);
+}
+
+template<typename ExecutionPolicy, typename KeyMapper, typename QueryTracer>
+std::vector<Document> SearchServer::FindTopDocumentsTraced(ExecutionPolicy&& policy, std::string_view raw_query,
+    KeyMapper key_mapper, size_t max_result_count, const CancellationToken& cancellation_token,
+    QueryTracer& tracer) const {
+    return SearchRawQuery(policy, raw_query, key_mapper, max_result_count, nullptr, &cancellation_token, tracer);
+}
+
+template<typename ExecutionPolicy, typename KeyMapper, typename QueryTracer>
+std::vector<Document> SearchServer::FindTopDocumentsTraced(ExecutionPolicy&& policy, std::string_view raw_query,
+    KeyMapper key_mapper, size_t max_result_count, const CorpusStatistics& corpus_statistics,
+    QueryTracer& tracer) const {
+    return SearchRawQuery(policy, raw_query, key_mapper, max_result_count, &corpus_statistics, nullptr, tracer);
+}
+
+template<typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+    DocumentStatus status, size_t max_result_count) const {
+    return FindTopDocuments(policy, raw_query, DocumentStatusFilter{ status }, max_result_count);
+}
+
+template<typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query) const {
+    return FindTopDocuments(policy, raw_query, DocumentStatus::ACTUAL);
+}
+
+template<typename KeyMapper>
+std::vector<Document> SearchServer::FindTopDocuments(const PreparedQuery& query, KeyMapper key_mapper,
+    size_t max_result_count) const {
+    return FindTopDocuments(std::execution::seq, query, key_mapper, max_result_count);
+}
+
+template<typename ExecutionPolicy, typename KeyMapper>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, const PreparedQuery& query,
+    KeyMapper key_mapper, size_t max_result_count) const {
+    NullQueryTracer tracer;
+    return FindTopDocumentsTraced(policy, query, key_mapper, max_result_count, tracer);
+}
+
+template<typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, const PreparedQuery& query,
+    DocumentStatus status, size_t max_result_count) const {
+    return FindTopDocuments(policy, query, DocumentStatusFilter{ status }, max_result_count);
+}
+
+template<typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, const PreparedQuery& query) const {
+    return FindTopDocuments(policy, query, DocumentStatus::ACTUAL);
+}
+
+template<typename ExecutionPolicy>
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(ExecutionPolicy&& policy,
+    std::string_view raw_query, int document_id) const {
+    return MatchTerms(policy, ResolveQuery(ParseQuery(raw_query)), document_id);
+}
+
+template<typename ExecutionPolicy>
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(ExecutionPolicy&& policy,
+    const PreparedQuery& query, int document_id) const {
+    return MatchTerms(policy, ResolveQuery(query), document_id);
+}
+
+template<typename ExecutionPolicy>
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchTerms(ExecutionPolicy&& policy,
+    const QueryTerms& query, int document_id) const {
+    const int ordinal = ordinal_by_id_.at(document_id);
+    const DocumentStatus status = documents_[ordinal].status;
+    const auto contains_document = [this, ordinal, status](InvertedIndex::TermId term) {
+        return index_.ContainsPosting(term, status, ordinal);
+    };
+
+    if (std::any_of(policy, query.minus_terms.begin(), query.minus_terms.end(), contains_document)) {
+        return { std::vector<std::string_view>(), status };
+    }
+
+    // Terms are unique and in word order already, so the words come out
+    // sorted without duplicates
+    std::vector<InvertedIndex::TermId> matched_terms(query.plus_terms.size());
+    matched_terms.erase(
+        std::copy_if(policy, query.plus_terms.begin(), query.plus_terms.end(), matched_terms.begin(), contains_document),
+        matched_terms.end());
+    std::vector<std::string_view> matched_words(matched_terms.size());
+    std::transform(matched_terms.begin(), matched_terms.end(), matched_words.begin(),
+        [this](InvertedIndex::TermId term) {
+            return index_.GetTerm(term);
+        });
+    return { matched_words, status };
+}
+
+template<typename ExecutionPolicy>
+void SearchServer::AddDocuments(ExecutionPolicy&& policy, const std::vector<DocumentInput>& documents) {
+    // Errors are kept and rethrown in input order, after the id check, just
+    // where AddDocument would throw them
+    struct TokenizedDocument {
+        std::map<std::string_view, double> word_freqs;
+        std::exception_ptr error;
+    };
+    std::vector<TokenizedDocument> tokenized_documents(documents.size());
+    std::transform(policy, documents.begin(), documents.end(), tokenized_documents.begin(),
+        [this](const DocumentInput& document) {
+            TokenizedDocument tokenized_document;
+            try {
+                tokenized_document.word_freqs = ComputeWordFreqs(document.document);
+            }
+            catch (...) {
+                tokenized_document.error = std::current_exception();
+            }
+            return tokenized_document;
+        });
+
+    // Documents are stored up to the first invalid one, which throws only once
+    // they are indexed
+    const int first_ordinal = static_cast<int>(documents_.size());
+    std::vector<InvertedIndex::NewDocument> new_documents;
+    std::exception_ptr error;
+    for (size_t i = 0; i < documents.size(); ++i) {
+        const DocumentInput& document = documents[i];
+        try {
+            CheckDocumentId(document.document_id);
+        }
+        catch (...) {
+            error = std::current_exception();
+            break;
+        }
+        if (tokenized_documents[i].error) {
+            error = tokenized_documents[i].error;
+            break;
+        }
+        ordinal_by_id_.emplace(document.document_id, static_cast<int>(documents_.size()));
+        documents_.push_back({ document.document_id, ComputeAverageRating(document.ratings), document.status });
+        live_ordinals_.PushBack();
+        new_documents.push_back({ document.status, std::move(tokenized_documents[i].word_freqs) });
+    }
+
+    if (!new_documents.empty()) {
+        index_.AddDocuments(policy, first_ordinal, std::move(new_documents));
+        log_document_count_ = std::log(static_cast<double>(GetDocumentCount()));
+        generation_ = TakeGeneration();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+template<typename ExecutionPolicy>
+void SearchServer::RemoveDocument(ExecutionPolicy&&, int document_id) {
+    const auto ordinal_it = ordinal_by_id_.find(document_id);
+    if (ordinal_it == ordinal_by_id_.end()) {
+        return;
+    }
+
+    index_.RemoveDocument(ordinal_it->second);
+    live_ordinals_.Remove(ordinal_it->second);
+    ordinal_by_id_.erase(ordinal_it);
+    log_document_count_ = std::log(static_cast<double>(GetDocumentCount()));
+    generation_ = TakeGeneration();
+}
+
+template<typename ExecutionPolicy>
+void SearchServer::Compact(ExecutionPolicy&& policy) {
+    const std::vector<int> new_ordinals = ComputeCompactOrdinals();
+    index_.Compact(policy, new_ordinals);
+
+    std::vector<DocumentData> documents;
+    documents.reserve(ordinal_by_id_.size());
+    for (size_t ordinal = 0; ordinal < documents_.size(); ++ordinal) {
+        if (new_ordinals[ordinal] >= 0) {
+            documents.push_back(documents_[ordinal]);
+        }
+    }
+    documents_ = std::move(documents);
+    live_ordinals_ = LiveOrdinals(std::vector<bool>(documents_.size(), true));
+    for (auto& [_, ordinal] : ordinal_by_id_) {
+        ordinal = new_ordinals[ordinal];
+    }
+}
+
+template <typename StrContainer>
+SearchServer::SearchServer(const StrContainer& stop_words)
+    : stop_words_(MakeNonEmptySetOfQueryWords(stop_words)) {
+
+    if (IsSpecialSymbolInCollection(stop_words_)) {
+        using namespace std;
+        throw invalid_argument("Special Symbol is in the collection of stop words"s);
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include "segmented_search_server.h"
+
+#include "string_processing.h"
+
+#include <cmath>
+#include <stdexcept>
+
+using namespace std;
+
+int SegmentedSearchServer::Segment::GetLiveDocumentCount() const {
+    return documents.GetDocumentCount() - static_cast<int>(tombstones.size());
+}
+
+SegmentedSearchServer::SegmentedSearchServer(const string& stop_words, int memtable_limit)
+    : empty_server_(stop_words), memtable_limit_(max(memtable_limit, 1)), memtable_(empty_server_) {
+    merge_thread_ = thread([this] {
+        RunMerges();
+    });
+}
+
+SegmentedSearchServer::~SegmentedSearchServer() {
+    {
+        unique_lock lock(mutex_);
+        is_stopping_ = true;
+    }
+    merge_condition_.notify_all();
+    merge_thread_.join();
+}
+
+void SegmentedSearchServer::AddDocument(int document_id, string_view document, DocumentStatus status,
+    const vector<int>& ratings) {
+    unique_lock lock(mutex_);
+    if (segment_by_document_id_.count(document_id) > 0) {
+        throw invalid_argument("Uncorrect ID of the document");
+    }
+    memtable_.AddDocument(document_id, document, status, ratings);
+    if (memtable_.GetDocumentCount() >= memtable_limit_) {
+        SealMemtable();
+    }
+}
+
+void SegmentedSearchServer::RemoveDocument(int document_id) {
+    unique_lock lock(mutex_);
+    const auto it = segment_by_document_id_.find(document_id);
+    if (it == segment_by_document_id_.end()) {
+        memtable_.RemoveDocument(document_id);
+        return;
+    }
+    AddTombstone(*it->second, document_id);
+    segment_by_document_id_.erase(it);
+}
+
+vector<Document> SegmentedSearchServer::FindTopDocuments(string_view raw_query, DocumentStatus status,
+    size_t max_result_count) const {
+    return FindTopDocuments(raw_query, DocumentStatusFilter{ status }, max_result_count);
+}
+
+vector<Document> SegmentedSearchServer::FindTopDocuments(string_view raw_query) const {
+    return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
+}
+
+int SegmentedSearchServer::GetDocumentCount() const {
+    shared_lock lock(mutex_);
+    return memtable_.GetDocumentCount() + static_cast<int>(segment_by_document_id_.size());
+}
+
+size_t SegmentedSearchServer::GetSegmentCount() const {
+    shared_lock lock(mutex_);
+    return segments_.size();
+}
+
+void SegmentedSearchServer::Flush() {
+    unique_lock lock(mutex_);
+    SealMemtable();
+}
+
+void SegmentedSearchServer::WaitForMerges() {
+    unique_lock lock(mutex_);
+    merge_condition_.wait(lock, [this] {
+        return !is_merging_ && PickSegmentsToMerge().empty();
+    });
+}
+
+void SegmentedSearchServer::SealMemtable() {
+    if (memtable_.GetDocumentCount() == 0) {
+        return;
+    }
+    auto segment = make_shared<Segment>(Segment{ move(memtable_), {}, {} });
+    memtable_ = empty_server_;
+    for (int i = 0; i < segment->documents.GetDocumentCount(); ++i) {
+        segment_by_document_id_[segment->documents.GetDocumentId(i)] = segment.get();
+    }
+    segments_.push_back(move(segment));
+    merge_condition_.notify_all();
+}
+
+void SegmentedSearchServer::AddTombstone(Segment& segment, int document_id) {
+    if (!segment.tombstones.insert(document_id).second) {
+        return;
+    }
+    for (const auto& [word, _] : segment.documents.GetWordFrequencies(document_id)) {
+        const auto it = segment.tombstone_document_freqs.find(word);
+        if (it == segment.tombstone_document_freqs.end()) {
+            segment.tombstone_document_freqs.emplace(word, 1);
+        }
+        else {
+            ++it->second;
+        }
+    }
+}
+
+CorpusStatistics SegmentedSearchServer::ComputeCorpusStatistics(string_view raw_query) const {
+    CorpusStatistics corpus_statistics;
+    corpus_statistics.document_count = memtable_.GetDocumentCount();
+    for (const shared_ptr<Segment>& segment : segments_) {
+        corpus_statistics.document_count += segment->GetLiveDocumentCount();
+    }
+
+    for (string_view word : SplitIntoWords(raw_query)) {
+        if (!word.empty() && word[0] == '-') {
+            continue;
+        }
+        if (corpus_statistics.document_freqs.count(word) > 0) {
+            continue;
+        }
+        int document_freq = memtable_.GetDocumentFreq(word);
+        for (const shared_ptr<Segment>& segment : segments_) {
+            document_freq += segment->documents.GetDocumentFreq(word);
+            const auto it = segment->tombstone_document_freqs.find(word);
+            if (it != segment->tombstone_document_freqs.end()) {
+                document_freq -= it->second;
+            }
+        }
+        corpus_statistics.document_freqs.emplace(word, document_freq);
+    }
+    return corpus_statistics;
+}
+
+vector<shared_ptr<SegmentedSearchServer::Segment>> SegmentedSearchServer::PickSegmentsToMerge() const {
+    map<int, vector<shared_ptr<Segment>>> segments_by_tier;
+    for (const shared_ptr<Segment>& segment : segments_) {
+        const double size_ratio = max(1.0, static_cast<double>(segment->documents.GetDocumentCount()) / memtable_limit_);
+        const int tier = static_cast<int>(log(size_ratio) / log(static_cast<double>(MERGE_FACTOR)));
+        vector<shared_ptr<Segment>>& tier_segments = segments_by_tier[tier];
+        tier_segments.push_back(segment);
+        if (tier_segments.size() == MERGE_FACTOR) {
+            return tier_segments;
+        }
+    }
+    return {};
+}
+
+void SegmentedSearchServer::RunMerges() {
+    unique_lock lock(mutex_);
+    while (true) {
+        vector<shared_ptr<Segment>> sources;
+        merge_condition_.wait(lock, [this, &sources] {
+            if (is_stopping_) {
+                return true;
+            }
+            sources = PickSegmentsToMerge();
+            return !sources.empty();
+        });
+        if (is_stopping_) {
+            return;
+        }
+
+        // Sealed documents never change, so only the tombstones are copied
+        // before the lock is released
+        vector<set<int>> merged_tombstones;
+        for (const shared_ptr<Segment>& source : sources) {
+            merged_tombstones.push_back(source->tombstones);
+        }
+        is_merging_ = true;
+        lock.unlock();
+
+        auto merged = make_shared<Segment>(Segment{ empty_server_, {}, {} });
+        for (size_t i = 0; i < sources.size(); ++i) {
+            merged->documents.AddDocumentsFrom(sources[i]->documents, merged_tombstones[i]);
+        }
+
+        lock.lock();
+        // Documents removed while the merge ran are still in the result
+        for (size_t i = 0; i < sources.size(); ++i) {
+            for (int document_id : sources[i]->tombstones) {
+                if (merged_tombstones[i].count(document_id) == 0) {
+                    AddTombstone(*merged, document_id);
+                }
+            }
+        }
+        for (int i = 0; i < merged->documents.GetDocumentCount(); ++i) {
+            const int document_id = merged->documents.GetDocumentId(i);
+            if (merged->tombstones.count(document_id) == 0) {
+                segment_by_document_id_[document_id] = merged.get();
+            }
+        }
+        const auto first_source = find(segments_.begin(), segments_.end(), sources.front());
+        *first_source = merged;
+        segments_.erase(remove_if(segments_.begin(), segments_.end(),
+            [&sources](const shared_ptr<Segment>& segment) {
+                return find(sources.begin() + 1, sources.end(), segment) != sources.end();
+            }), segments_.end());
+        is_merging_ = false;
+        merge_condition_.notify_all();
+    }
+}
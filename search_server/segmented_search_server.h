@@ -0,0 +1,143 @@
+#pragma once
+
+#include "document.h"
+#include "search_server.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Search server made of segments, in the manner of an LSM tree.
+//
+// New documents go to a small mutable SearchServer, the memtable. Once it
+// holds memtable_limit documents it is sealed into an immutable segment. A
+// background thread merges segments of similar size: a segment with about
+// memtable_limit * MERGE_FACTOR^k documents is in tier k, and MERGE_FACTOR
+// segments of one tier are merged into one of the next tier. Merging copies
+// postings and never tokenizes again.
+//
+// Removing a document from a sealed segment only records a tombstone. Searches
+// skip tombstones, statistics subtract them and the next merge drops them.
+//
+// A search asks every segment for its top documents, scoring them with the
+// IDF of the whole live corpus, and merges the answers. Results are the same
+// as those of one SearchServer holding all live documents.
+class SegmentedSearchServer {
+public:
+    static constexpr int DEFAULT_MEMTABLE_LIMIT = 10000;
+    static constexpr size_t MERGE_FACTOR = 4;
+
+    explicit SegmentedSearchServer(const std::string& stop_words, int memtable_limit = DEFAULT_MEMTABLE_LIMIT);
+
+    // Stops the merge thread. A merge in progress is finished first.
+    ~SegmentedSearchServer();
+
+    SegmentedSearchServer(const SegmentedSearchServer&) = delete;
+    SegmentedSearchServer& operator=(const SegmentedSearchServer&) = delete;
+
+    // Throws like SearchServer::AddDocument, ids must be unique across segments
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+
+    void RemoveDocument(int document_id);
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
+
+    int GetDocumentCount() const;
+
+    // Sealed segments, not counting the memtable
+    size_t GetSegmentCount() const;
+
+    // Seals the memtable even if it is not full
+    void Flush();
+
+    // Blocks until no tier has enough segments to merge
+    void WaitForMerges();
+
+private:
+    struct Segment {
+        SearchServer documents;
+        std::set<int> tombstones;
+        // How many tombstones contain each word
+        std::map<std::string, int, std::less<>> tombstone_document_freqs;
+
+        int GetLiveDocumentCount() const;
+    };
+
+    // Carries the stop words; every new memtable and merged segment starts as its copy
+    const SearchServer empty_server_;
+    const int memtable_limit_;
+
+    // Searches hold it shared, changes of the memtable, tombstones and the
+    // segment list hold it exclusively. Merging itself runs without it.
+    mutable std::shared_mutex mutex_;
+    std::condition_variable_any merge_condition_;
+    SearchServer memtable_;
+    std::vector<std::shared_ptr<Segment>> segments_;
+    std::map<int, Segment*> segment_by_document_id_;
+    bool is_merging_ = false;
+    bool is_stopping_ = false;
+    std::thread merge_thread_;
+
+    void SealMemtable();
+
+    void AddTombstone(Segment& segment, int document_id);
+
+    CorpusStatistics ComputeCorpusStatistics(std::string_view raw_query) const;
+
+    // Segments of the lowest tier that has MERGE_FACTOR of them, or nothing
+    std::vector<std::shared_ptr<Segment>> PickSegmentsToMerge() const;
+
+    void RunMerges();
+};
+
+template <typename DocumentPredicate>
+std::vector<Document> SegmentedSearchServer::FindTopDocuments(std::string_view raw_query,
+    DocumentPredicate document_predicate, size_t max_result_count) const {
+    std::shared_lock lock(mutex_);
+    const CorpusStatistics corpus_statistics = ComputeCorpusStatistics(raw_query);
+    if (corpus_statistics.document_count == 0) {
+        // Nothing is live, the memtable still validates the query
+        return memtable_.FindTopDocuments(std::execution::seq, raw_query, document_predicate, max_result_count);
+    }
+
+    // The top of the union is among the tops of the parts
+    std::vector<Document> documents = memtable_.FindTopDocuments(std::execution::seq, raw_query, document_predicate,
+        max_result_count, corpus_statistics);
+    for (const std::shared_ptr<Segment>& segment : segments_) {
+        std::vector<Document> segment_documents;
+        if (segment->tombstones.empty()) {
+            segment_documents = segment->documents.FindTopDocuments(std::execution::seq, raw_query, document_predicate,
+                max_result_count, corpus_statistics);
+        }
+        else {
+            segment_documents = segment->documents.FindTopDocuments(std::execution::seq, raw_query,
+                [&segment, &document_predicate](int document_id, DocumentStatus status, int rating) {
+                    return segment->tombstones.count(document_id) == 0 && document_predicate(document_id, status, rating);
+                }, max_result_count, corpus_statistics);
+        }
+        documents.insert(documents.end(), segment_documents.begin(), segment_documents.end());
+    }
+
+    if (documents.size() > max_result_count) {
+        std::partial_sort(documents.begin(), documents.begin() + max_result_count, documents.end(), IsMoreRelevant);
+        documents.resize(max_result_count);
+    }
+    else {
+        std::sort(documents.begin(), documents.end(), IsMoreRelevant);
+    }
+    return documents;
+}
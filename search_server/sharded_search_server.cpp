@@ -0,0 +1,95 @@
+#include "sharded_search_server.h"
+
+#include "string_processing.h"
+
+#include <cstdint>
+
+using namespace std;
+
+namespace {
+
+// Consecutive ids land on different shards
+size_t HashDocumentId(int document_id) {
+    uint64_t hash = static_cast<uint32_t>(document_id);
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bull;
+    hash ^= hash >> 16;
+    return static_cast<size_t>(hash);
+}
+
+}  // namespace
+
+ShardedSearchServer::ShardedSearchServer(const string& stop_words, size_t shard_count)
+    : shards_(max<size_t>(shard_count, 1), SearchServer(stop_words)) {
+}
+
+void ShardedSearchServer::AddDocument(int document_id, string_view document, DocumentStatus status,
+    const vector<int>& ratings) {
+    GetShardOf(document_id).AddDocument(document_id, document, status, ratings);
+}
+
+void ShardedSearchServer::RemoveDocument(int document_id) {
+    GetShardOf(document_id).RemoveDocument(document_id);
+}
+
+void ShardedSearchServer::Compact() {
+    for_each(execution::par, shards_.begin(), shards_.end(), [](SearchServer& shard) {
+        if (shard.GetRemovedDocumentCount() > shard.GetDocumentCount()) {
+            shard.Compact();
+        }
+    });
+}
+
+vector<Document> ShardedSearchServer::FindTopDocuments(string_view raw_query, DocumentStatus status,
+    size_t max_result_count) const {
+    return FindTopDocuments(raw_query, DocumentStatusFilter{ status }, max_result_count);
+}
+
+vector<Document> ShardedSearchServer::FindTopDocuments(string_view raw_query) const {
+    return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
+}
+
+tuple<vector<string_view>, DocumentStatus> ShardedSearchServer::MatchDocument(string_view raw_query,
+    int document_id) const {
+    return GetShardOf(document_id).MatchDocument(raw_query, document_id);
+}
+
+int ShardedSearchServer::GetDocumentCount() const {
+    int document_count = 0;
+    for (const SearchServer& shard : shards_) {
+        document_count += shard.GetDocumentCount();
+    }
+    return document_count;
+}
+
+size_t ShardedSearchServer::GetShardCount() const {
+    return shards_.size();
+}
+
+const SearchServer& ShardedSearchServer::GetShard(size_t shard_index) const {
+    return shards_.at(shard_index);
+}
+
+SearchServer& ShardedSearchServer::GetShardOf(int document_id) {
+    return shards_[HashDocumentId(document_id) % shards_.size()];
+}
+
+const SearchServer& ShardedSearchServer::GetShardOf(int document_id) const {
+    return shards_[HashDocumentId(document_id) % shards_.size()];
+}
+
+CorpusStatistics ShardedSearchServer::ComputeCorpusStatistics(string_view raw_query) const {
+    CorpusStatistics corpus_statistics;
+    corpus_statistics.document_count = GetDocumentCount();
+    for (string_view word : SplitIntoWords(raw_query)) {
+        if ((!word.empty() && word[0] == '-') || corpus_statistics.document_freqs.count(word) > 0) {
+            continue;
+        }
+        int document_freq = 0;
+        for (const SearchServer& shard : shards_) {
+            document_freq += shard.GetDocumentFreq(word);
+        }
+        corpus_statistics.document_freqs.emplace(word, document_freq);
+    }
+    return corpus_statistics;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "document.h"
+#include "search_server.h"
+
+#include <algorithm>
+#include <exception>
+#include <execution>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+// Documents spread over several SearchServers by a hash of their id. Every
+// call about one document goes to its shard; a search runs on all shards in
+// parallel and merges their tops.
+//
+// Shards score with document frequencies summed over all of them, so a
+// search returns exactly what one SearchServer with all documents would.
+class ShardedSearchServer {
+public:
+    ShardedSearchServer(const std::string& stop_words, size_t shard_count);
+
+    // Throws like SearchServer::AddDocument
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+
+    void RemoveDocument(int document_id);
+
+    // Compacts every shard with more removed documents than live ones,
+    // see SearchServer::Compact
+    void Compact();
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+        size_t max_result_count = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
+
+    // Words stay valid for the lifetime of the server
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view raw_query,
+        int document_id) const;
+
+    int GetDocumentCount() const;
+
+    size_t GetShardCount() const;
+
+    const SearchServer& GetShard(size_t shard_index) const;
+
+private:
+    std::vector<SearchServer> shards_;
+
+    SearchServer& GetShardOf(int document_id);
+
+    const SearchServer& GetShardOf(int document_id) const;
+
+    CorpusStatistics ComputeCorpusStatistics(std::string_view raw_query) const;
+};
+
+template <typename DocumentPredicate>
+std::vector<Document> ShardedSearchServer::FindTopDocuments(std::string_view raw_query,
+    DocumentPredicate document_predicate, size_t max_result_count) const {
+    const CorpusStatistics corpus_statistics = ComputeCorpusStatistics(raw_query);
+
+    // An exception escaping a parallel algorithm terminates the program, so an
+    // invalid query is caught on the shards and rethrown here
+    std::vector<std::vector<Document>> shard_documents(shards_.size());
+    std::vector<std::exception_ptr> shard_errors(shards_.size());
+    std::for_each(std::execution::par, shards_.begin(), shards_.end(),
+        [&](const SearchServer& shard) {
+            const size_t shard_index = &shard - shards_.data();
+            try {
+                shard_documents[shard_index] = shard.FindTopDocuments(std::execution::seq, raw_query,
+                    document_predicate, max_result_count, corpus_statistics);
+            }
+            catch (...) {
+                shard_errors[shard_index] = std::current_exception();
+            }
+        });
+    for (const std::exception_ptr& shard_error : shard_errors) {
+        if (shard_error) {
+            std::rethrow_exception(shard_error);
+        }
+    }
+
+    // The top of the union is among the tops of the shards
+    std::vector<Document> documents;
+    for (const std::vector<Document>& top_documents : shard_documents) {
+        documents.insert(documents.end(), top_documents.begin(), top_documents.end());
+    }
+    if (documents.size() > max_result_count) {
+        std::partial_sort(documents.begin(), documents.begin() + max_result_count, documents.end(), IsMoreRelevant);
+        documents.resize(max_result_count);
+    }
+    else {
+        std::sort(documents.begin(), documents.end(), IsMoreRelevant);
+    }
+    return documents;
+}
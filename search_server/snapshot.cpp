@@ -0,0 +1,146 @@
+#include "snapshot.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+constexpr char SNAPSHOT_MAGIC[8] = { 'S', 'R', 'V', 'S', 'N', 'A', 'P', '\0' };
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order_mark;
+    uint64_t payload_size;
+    uint64_t checksum;
+};
+
+// Writes all bytes, resuming after partial writes and interrupts
+bool WriteAll(int fd, const char* bytes, size_t byte_count) {
+    while (byte_count > 0) {
+        const ssize_t written = write(fd, bytes, byte_count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += written;
+        byte_count -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// Makes a rename inside the directory of path durable
+void SyncParentDirectory(const string& path) {
+    const size_t slash = path.rfind('/');
+    const string directory = slash == string::npos ? "."s : slash == 0 ? "/"s : path.substr(0, slash);
+    const int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+uint64_t ComputeChecksum(const vector<char>& payload) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char byte : payload) {
+        hash ^= static_cast<uint8_t>(byte);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+}  // namespace
+
+void SnapshotWriter::WriteString(string_view value) {
+    Write<uint64_t>(value.size());
+    payload_.insert(payload_.end(), value.begin(), value.end());
+}
+
+void SnapshotWriter::SaveToFile(const string& path) const {
+    SnapshotHeader header{};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order_mark = BYTE_ORDER_MARK;
+    header.payload_size = payload_.size();
+    header.checksum = ComputeChecksum(payload_);
+
+    // The old snapshot stays in place until the new one is complete on disk,
+    // so a crash leaves one of the two, never a torn file
+    const string temporary_path = path + ".tmp"s;
+    const int fd = open(temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        throw runtime_error("Cannot write snapshot " + path);
+    }
+    const bool is_written = WriteAll(fd, reinterpret_cast<const char*>(&header), sizeof(header))
+        && WriteAll(fd, payload_.data(), payload_.size())
+        && fsync(fd) == 0;
+    if (close(fd) != 0 || !is_written || rename(temporary_path.c_str(), path.c_str()) != 0) {
+        unlink(temporary_path.c_str());
+        throw runtime_error("Cannot write snapshot " + path);
+    }
+    SyncParentDirectory(path);
+}
+
+SnapshotReader SnapshotReader::LoadFromFile(const string& path) {
+    ifstream in(path, ios::binary);
+    if (!in) {
+        throw runtime_error("Cannot open snapshot " + path);
+    }
+
+    SnapshotHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        throw runtime_error(path + " is not a snapshot");
+    }
+    if (header.version != SNAPSHOT_VERSION || header.byte_order_mark != BYTE_ORDER_MARK) {
+        throw runtime_error("Snapshot " + path + " has an unsupported version or byte order");
+    }
+
+    // The size is checked against the file before anything is allocated for it
+    const streamoff payload_begin = in.tellg();
+    in.seekg(0, ios::end);
+    if (static_cast<uint64_t>(in.tellg() - payload_begin) != header.payload_size) {
+        throw runtime_error("Snapshot " + path + " has a wrong size");
+    }
+    in.seekg(payload_begin);
+
+    SnapshotReader reader;
+    reader.payload_.resize(header.payload_size);
+    if (!in.read(reader.payload_.data(), static_cast<streamsize>(header.payload_size))) {
+        throw runtime_error("Cannot read snapshot " + path);
+    }
+    if (ComputeChecksum(reader.payload_) != header.checksum) {
+        throw runtime_error("Snapshot " + path + " is corrupted");
+    }
+    return reader;
+}
+
+string SnapshotReader::ReadString() {
+    const uint64_t size = Read<uint64_t>();
+    if (size > payload_.size() - offset_) {
+        throw runtime_error("Snapshot is truncated");
+    }
+    return string(Take(size), size);
+}
+
+bool SnapshotReader::AtEnd() const {
+    return offset_ == payload_.size();
+}
+
+const char* SnapshotReader::Take(size_t byte_count) {
+    if (byte_count > payload_.size() - offset_) {
+        throw runtime_error("Snapshot is truncated");
+    }
+    const char* bytes = payload_.data() + offset_;
+    offset_ += byte_count;
+    return bytes;
+}
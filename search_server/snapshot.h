@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Binary snapshot files. A file is a fixed header followed by the payload:
+//
+//   magic "SRVSNAP\0" | version u32 | byte order mark u32 | payload size u64 | checksum u64
+//
+// The checksum is FNV-1a over the payload. Values are written in the byte
+// order of the machine that wrote them; the byte order mark makes a snapshot
+// from a machine with the other order fail to load instead of loading garbage.
+// Arrays are a u64 element count followed by the raw elements, so they are
+// read back with a single copy.
+inline constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+class SnapshotWriter {
+public:
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        payload_.insert(payload_.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    void WriteArray(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Write<uint64_t>(values.size());
+        const char* bytes = reinterpret_cast<const char*>(values.data());
+        payload_.insert(payload_.end(), bytes, bytes + values.size() * sizeof(T));
+    }
+
+    void WriteString(std::string_view value);
+
+    // Writes path + ".tmp", syncs it and renames it over path, so the previous
+    // file survives a crash mid-write. Throws std::runtime_error if the file
+    // cannot be written.
+    void SaveToFile(const std::string& path) const;
+
+private:
+    std::vector<char> payload_;
+};
+
+class SnapshotReader {
+public:
+    // Throws std::runtime_error if the file cannot be read, was written by
+    // another version or byte order, or fails the checksum
+    static SnapshotReader LoadFromFile(const std::string& path);
+
+    template <typename T>
+    T Read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    std::vector<T> ReadArray() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const uint64_t size = Read<uint64_t>();
+        if (size > (payload_.size() - offset_) / sizeof(T)) {
+            throw std::runtime_error("Snapshot is truncated");
+        }
+        std::vector<T> values(size);
+        std::memcpy(values.data(), Take(size * sizeof(T)), size * sizeof(T));
+        return values;
+    }
+
+    std::string ReadString();
+
+    bool AtEnd() const;
+
+private:
+    std::vector<char> payload_;
+    size_t offset_ = 0;
+
+    const char* Take(size_t byte_count);
+};
@@ -1,24 +1,22 @@
-#include "string_processing.h"
-
-using namespace std;
-
-vector<string> SplitIntoWords(const string& text) {
-    vector<string> words;
-    string word;
-    for (const char c : text) {
-        if (c == ' ') {
-            if (!word.empty()) {
-                words.push_back(word);
-                word.clear();
-            }
-        }
-        else {
-            word += c;
-        }
-    }
-    if (!word.empty()) {
-        words.push_back(word);
-    }
-
-    return words;
-}
\ No newline at end of file
+#include "string_processing.h"
+
+using namespace std;
+
+vector<string_view> SplitIntoWords(string_view text) {
+    vector<string_view> words;
+    while (true) {
+        const size_t word_begin = text.find_first_not_of(' ');
+        if (word_begin == text.npos) {
+            break;
+        }
+        text.remove_prefix(word_begin);
+        const size_t word_end = text.find(' ');
+        words.push_back(text.substr(0, word_end));
+        if (word_end == text.npos) {
+            break;
+        }
+        text.remove_prefix(word_end);
+    }
+
+    return words;
+}
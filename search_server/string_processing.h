@@ -1,24 +1,25 @@
-#pragma once
-
-#include<iostream>
-#include<set>
-#include<string>
-#include<vector>
-
-
-std::vector<std::string> SplitIntoWords(const std::string& text);
-
-template <typename StrContainer>
-std::set<std::string> MakeNonEmptySetOfQueryWords(const StrContainer& strings);
-
-
-template <typename StrContainer>
-std::set<std::string> MakeNonEmptySetOfQueryWords(const StrContainer& strings) {
-    std::set<std::string> non_empty_query_set;
-    for (const std::string& str : strings) {
-        if (!str.empty()) {
-            non_empty_query_set.insert(str);
-        }
-    }
-    return non_empty_query_set;
-}
\ No newline at end of file
+#pragma once
+
+#include<iostream>
+#include<set>
+#include<string>
+#include<string_view>
+#include<vector>
+
+
+std::vector<std::string_view> SplitIntoWords(std::string_view text);
+
+template <typename StrContainer>
+std::set<std::string, std::less<>> MakeNonEmptySetOfQueryWords(const StrContainer& strings);
+
+
+template <typename StrContainer>
+std::set<std::string, std::less<>> MakeNonEmptySetOfQueryWords(const StrContainer& strings) {
+    std::set<std::string, std::less<>> non_empty_query_set;
+    for (std::string_view str : strings) {
+        if (!str.empty()) {
+            non_empty_query_set.emplace(str);
+        }
+    }
+    return non_empty_query_set;
+}
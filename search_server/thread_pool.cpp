@@ -0,0 +1,94 @@
+#include "thread_pool.h"
+
+using namespace std;
+
+namespace {
+
+// Pool and worker the current thread belongs to, if any
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_worker_index = 0;
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    thread_count = max<size_t>(thread_count, 1);
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers_.push_back(make_unique<Worker>());
+    }
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads_.emplace_back([this, i] {
+            RunWorker(i);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard guard(idle_mutex_);
+        is_stopping_ = true;
+    }
+    idle_condition_.notify_all();
+    for (thread& worker_thread : threads_) {
+        worker_thread.join();
+    }
+}
+
+size_t ThreadPool::GetThreadCount() const {
+    return threads_.size();
+}
+
+void ThreadPool::Push(function<void()> task) {
+    const size_t worker_index = current_pool == this
+        ? current_worker_index
+        : next_worker_++ % workers_.size();
+    {
+        lock_guard guard(workers_[worker_index]->mutex);
+        workers_[worker_index]->tasks.push_back(move(task));
+    }
+    {
+        lock_guard guard(idle_mutex_);
+        ++pending_task_count_;
+    }
+    idle_condition_.notify_one();
+}
+
+bool ThreadPool::TryPop(size_t worker_index, function<void()>& task) {
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        Worker& worker = *workers_[(worker_index + i) % workers_.size()];
+        lock_guard guard(worker.mutex);
+        if (worker.tasks.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            task = move(worker.tasks.back());
+            worker.tasks.pop_back();
+        }
+        else {
+            task = move(worker.tasks.front());
+            worker.tasks.pop_front();
+        }
+        lock_guard idle_guard(idle_mutex_);
+        --pending_task_count_;
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::RunWorker(size_t worker_index) {
+    current_pool = this;
+    current_worker_index = worker_index;
+    while (true) {
+        function<void()> task;
+        if (TryPop(worker_index, task)) {
+            task();
+            continue;
+        }
+        unique_lock lock(idle_mutex_);
+        idle_condition_.wait(lock, [this] {
+            return pending_task_count_ > 0 || is_stopping_;
+        });
+        if (pending_task_count_ == 0 && is_stopping_) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads with a task deque each. A worker takes its own
+// newest task first and, when it has none, steals the oldest task of another
+// worker. Tasks submitted by a worker go to its own deque, so sub-tasks stay
+// on the thread that made them unless someone else is idle.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t thread_count = std::thread::hardware_concurrency());
+
+    // Runs the tasks already submitted, then joins the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t GetThreadCount() const;
+
+    // The future carries the result or the exception of the task
+    template <typename Function>
+    std::future<std::invoke_result_t<Function>> Submit(Function function);
+
+    // Calls function(index) for every index in [0, count) on the workers and
+    // the calling thread, and returns once all calls are done. The calling
+    // thread runs only calls of this loop, so it may be a worker itself. The
+    // first exception of a call is rethrown after the others finish.
+    template <typename Function>
+    void ParallelFor(size_t count, Function function);
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> next_worker_ = 0;
+
+    // Counts tasks in all deques; workers sleep while it is zero
+    std::mutex idle_mutex_;
+    std::condition_variable idle_condition_;
+    size_t pending_task_count_ = 0;
+    bool is_stopping_ = false;
+
+    void Push(std::function<void()> task);
+
+    bool TryPop(size_t worker_index, std::function<void()>& task);
+
+    void RunWorker(size_t worker_index);
+};
+
+template <typename Function>
+std::future<std::invoke_result_t<Function>> ThreadPool::Submit(Function function) {
+    // std::function needs a copyable target, packaged_task is move-only
+    auto task = std::make_shared<std::packaged_task<std::invoke_result_t<Function>()>>(std::move(function));
+    std::future<std::invoke_result_t<Function>> result = task->get_future();
+    Push([task] {
+        (*task)();
+    });
+    return result;
+}
+
+template <typename Function>
+void ThreadPool::ParallelFor(size_t count, Function function) {
+    struct LoopState {
+        std::atomic<size_t> next_index = 0;
+        std::atomic<size_t> done_count = 0;
+        std::mutex mutex;
+        std::condition_variable done_condition;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<LoopState>();
+
+    // A helper that starts after every index is taken returns at once without
+    // touching function, so it may run after ParallelFor has returned
+    auto run_calls = [state, &function, count] {
+        for (size_t index; (index = state->next_index++) < count;) {
+            try {
+                function(index);
+            }
+            catch (...) {
+                std::lock_guard guard(state->mutex);
+                if (!state->error) {
+                    state->error = std::current_exception();
+                }
+            }
+            if (++state->done_count == count) {
+                std::lock_guard guard(state->mutex);
+                state->done_condition.notify_all();
+            }
+        }
+    };
+
+    for (size_t i = 1; i < std::min(count, workers_.size() + 1); ++i) {
+        Push(run_calls);
+    }
+    run_calls();
+
+    std::unique_lock lock(state->mutex);
+    state->done_condition.wait(lock, [&state, count] {
+        return state->done_count == count;
+    });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
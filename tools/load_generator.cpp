@@ -0,0 +1,270 @@
+// Load generator for search_daemon. Linux only.
+//
+// Build from this directory:
+//     g++ -std=c++17 -O2 load_generator.cpp -pthread -o load_generator
+//
+// Usage: load_generator [--port PORT | --unix PATH] [--connections N] [--pipeline DEPTH]
+//                       [--seconds S] [--documents D] [--words W]
+//
+// First fills the daemon with D random documents, then keeps N connections
+// busy for S seconds, each with DEPTH FIND requests in flight. Words of both
+// documents and queries follow a Zipf distribution over W distinct words.
+// Prints the throughput and latency percentiles of the FIND requests.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+struct Options {
+    int port = 7411;
+    string unix_path;
+    int connections = 4;
+    int pipeline = 8;
+    int seconds = 10;
+    int documents = 10000;
+    int words = 5000;
+};
+
+int Connect(const Options& options) {
+    int fd = -1;
+    int result = -1;
+    if (!options.unix_path.empty()) {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, options.unix_path.c_str(), sizeof(address.sun_path) - 1);
+        result = connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    }
+    else {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(options.port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        result = connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    }
+    if (fd == -1 || result == -1) {
+        throw runtime_error("Cannot connect: "s + strerror(errno));
+    }
+    return fd;
+}
+
+// Blocking line-oriented connection
+class LineConnection {
+public:
+    explicit LineConnection(const Options& options)
+        : fd_(Connect(options)) {
+    }
+
+    ~LineConnection() {
+        close(fd_);
+    }
+
+    void Send(string_view data) {
+        while (!data.empty()) {
+            const ssize_t written = write(fd_, data.data(), data.size());
+            if (written <= 0) {
+                throw runtime_error("Connection lost");
+            }
+            data.remove_prefix(written);
+        }
+    }
+
+    string ReceiveLine() {
+        size_t line_end;
+        while ((line_end = input_.find('\n')) == string::npos) {
+            char buffer[64 * 1024];
+            const ssize_t size = read(fd_, buffer, sizeof(buffer));
+            if (size <= 0) {
+                throw runtime_error("Connection lost");
+            }
+            input_.append(buffer, size);
+        }
+        string line = input_.substr(0, line_end);
+        input_.erase(0, line_end + 1);
+        return line;
+    }
+
+private:
+    int fd_;
+    string input_;
+};
+
+class ZipfWords {
+public:
+    explicit ZipfWords(int word_count)
+        : word_count_(word_count) {
+    }
+
+    string operator()(mt19937& generator) const {
+        const double u = uniform_real_distribution<>(0.0, 1.0)(generator);
+        return "w" + to_string(static_cast<int>(pow(static_cast<double>(word_count_), u)) - 1);
+    }
+
+private:
+    int word_count_;
+};
+
+void LoadDocuments(const Options& options) {
+    LineConnection connection(options);
+    mt19937 generator(1);
+    const ZipfWords zipf_words(options.words);
+    string batch;
+    for (int id = 0; id < options.documents; ++id) {
+        batch += "ADD " + to_string(id) + " ACTUAL " + to_string(generator() % 10) + ",5";
+        for (int i = 0; i < 30; ++i) {
+            batch += ' ' + zipf_words(generator);
+        }
+        batch += '\n';
+    }
+    connection.Send(batch);
+    for (int id = 0; id < options.documents; ++id) {
+        const string answer = connection.ReceiveLine();
+        if (answer != "OK") {
+            throw runtime_error("ADD failed: " + answer);
+        }
+    }
+}
+
+using Clock = chrono::steady_clock;
+
+// Returns the latencies of the answered requests in microseconds
+vector<double> RunClient(const Options& options, int seed, Clock::time_point deadline) {
+    LineConnection connection(options);
+    mt19937 generator(seed);
+    const ZipfWords zipf_words(options.words);
+    deque<Clock::time_point> sent_times;
+    vector<double> latencies;
+
+    auto send_request = [&] {
+        string request = "FIND 5";
+        for (int i = 0; i < 3; ++i) {
+            request += ' ' + zipf_words(generator);
+        }
+        request += '\n';
+        sent_times.push_back(Clock::now());
+        connection.Send(request);
+    };
+
+    for (int i = 0; i < options.pipeline; ++i) {
+        send_request();
+    }
+    while (!sent_times.empty()) {
+        const string answer = connection.ReceiveLine();
+        const Clock::time_point now = Clock::now();
+        if (answer.rfind("FOUND", 0) != 0) {
+            throw runtime_error("FIND failed: " + answer);
+        }
+        latencies.push_back(chrono::duration<double, micro>(now - sent_times.front()).count());
+        sent_times.pop_front();
+        if (now < deadline) {
+            send_request();
+        }
+    }
+    return latencies;
+}
+
+double Percentile(const vector<double>& sorted_values, double fraction) {
+    if (sorted_values.empty()) {
+        return 0.0;
+    }
+    const size_t index = min(sorted_values.size() - 1, static_cast<size_t>(fraction * sorted_values.size()));
+    return sorted_values[index];
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const string_view option = argv[i];
+        const string value = argv[i + 1];
+        if (option == "--port") {
+            options.port = stoi(value);
+        }
+        else if (option == "--unix") {
+            options.unix_path = value;
+        }
+        else if (option == "--connections") {
+            options.connections = max(1, stoi(value));
+        }
+        else if (option == "--pipeline") {
+            options.pipeline = max(1, stoi(value));
+        }
+        else if (option == "--seconds") {
+            options.seconds = stoi(value);
+        }
+        else if (option == "--documents") {
+            options.documents = stoi(value);
+        }
+        else if (option == "--words") {
+            options.words = max(1, stoi(value));
+        }
+        else {
+            cerr << "Unknown option " << option << endl;
+            return 1;
+        }
+    }
+
+    try {
+        LoadDocuments(options);
+
+        const Clock::time_point start = Clock::now();
+        const Clock::time_point deadline = start + chrono::seconds(options.seconds);
+        vector<vector<double>> client_latencies(options.connections);
+        vector<thread> clients;
+        atomic<bool> has_failed = false;
+        for (int i = 0; i < options.connections; ++i) {
+            clients.emplace_back([&, i] {
+                try {
+                    client_latencies[i] = RunClient(options, i + 2, deadline);
+                }
+                catch (const exception& e) {
+                    cerr << e.what() << endl;
+                    has_failed = true;
+                }
+            });
+        }
+        for (thread& client : clients) {
+            client.join();
+        }
+        const double elapsed_seconds = chrono::duration<double>(Clock::now() - start).count();
+        if (has_failed) {
+            return 1;
+        }
+
+        vector<double> latencies;
+        for (const vector<double>& values : client_latencies) {
+            latencies.insert(latencies.end(), values.begin(), values.end());
+        }
+        sort(latencies.begin(), latencies.end());
+        cout << "requests " << latencies.size() << ", " << latencies.size() / elapsed_seconds << " per second" << endl;
+        cout << "latency us: p50 " << Percentile(latencies, 0.5) << ", p99 " << Percentile(latencies, 0.99)
+             << ", p99.9 " << Percentile(latencies, 0.999) << ", max " << (latencies.empty() ? 0.0 : latencies.back())
+             << endl;
+    }
+    catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,472 @@
+// Daemon serving one SearchServer over a line protocol. Linux only: the
+// event loop is built on epoll.
+//
+// Build from this directory:
+//     g++ -std=c++17 -O2 -I../search_server search_daemon.cpp $(ls ../search_server/*.cpp | grep -v main.cpp) -ltbb -pthread -o search_daemon
+//
+// Usage: search_daemon [--port PORT | --unix PATH] [--stop-words WORDS]
+// Listens on 127.0.0.1:PORT (default 7411) or on a Unix socket.
+//
+// One command per line, fields separated by single spaces, so an empty field
+// is two spaces in a row. Clients may pipeline any number of commands; the
+// answers come back in the order of the commands of that connection. A last
+// command without a line end runs once the client closes its side. A line
+// longer than MAX_LINE_SIZE closes the connection.
+//     ADD <id> <status> <ratings> <text>  -> OK
+//         status is ACTUAL, IRRELEVANT, BANNED or REMOVED, ratings are
+//         comma-separated integers, possibly none
+//     REMOVE <id>                         -> OK
+//     FIND <count> <query>                -> FOUND <n> (<id> <relevance> <rating>)*
+//     MATCH <id> <query>                  -> MATCHED <status> <word>*
+// A command that fails is answered with ERROR <message>.
+//
+// Every pass of the event loop reads what all connections have sent. Reading
+// commands (FIND, MATCH) between two writing ones form a batch that runs on
+// the thread pool of std::execution::par; writes run alone, in order, so
+// readers never see a half-done change. Answers are written with writev
+// straight from the strings they were formatted into. Once removed documents
+// outnumber the live ones, they are compacted away the next time the loop
+// finds nothing to do.
+
+#include "search_server.h"
+#include "string_processing.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <execution>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+constexpr size_t MAX_LINE_SIZE = 4 * 1024 * 1024;
+constexpr int MAX_EVENTS = 256;
+constexpr int MAX_IOVECS = 64;
+constexpr int DEFAULT_PORT = 7411;
+
+struct Connection {
+    int fd = -1;
+    string input;
+    // Answers not written yet; the first one is written up to output_offset
+    deque<string> output;
+    size_t output_offset = 0;
+    bool is_reading_closed = false;
+    // Events the fd is registered for in epoll
+    uint32_t watched_events = EPOLLIN;
+};
+
+struct Command {
+    Connection* connection;
+    string line;
+    string answer;
+};
+
+void ThrowSystemError(const string& what) {
+    throw runtime_error(what + ": " + strerror(errno));
+}
+
+void SetNonBlocking(int fd) {
+    if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) == -1) {
+        ThrowSystemError("fcntl");
+    }
+}
+
+// Cuts the first field and the space after it off text
+string_view TakeField(string_view& text) {
+    const size_t end = min(text.find(' '), text.size());
+    const string_view field = text.substr(0, end);
+    text.remove_prefix(min(end + 1, text.size()));
+    return field;
+}
+
+int ParseInt(string_view text) {
+    int value = 0;
+    const auto [end, error] = from_chars(text.data(), text.data() + text.size(), value);
+    if (error != errc() || end != text.data() + text.size()) {
+        throw invalid_argument("Bad number "s + string(text));
+    }
+    return value;
+}
+
+constexpr string_view STATUS_NAMES[] = { "ACTUAL", "IRRELEVANT", "BANNED", "REMOVED" };
+
+DocumentStatus ParseStatus(string_view text) {
+    const auto it = find(begin(STATUS_NAMES), end(STATUS_NAMES), text);
+    if (it == end(STATUS_NAMES)) {
+        throw invalid_argument("Bad status "s + string(text));
+    }
+    return static_cast<DocumentStatus>(it - begin(STATUS_NAMES));
+}
+
+vector<int> ParseRatings(string_view text) {
+    vector<int> ratings;
+    while (!text.empty()) {
+        const size_t end = min(text.find(','), text.size());
+        ratings.push_back(ParseInt(text.substr(0, end)));
+        text.remove_prefix(min(end + 1, text.size()));
+    }
+    return ratings;
+}
+
+bool IsWriteCommand(string_view line) {
+    const string_view name = TakeField(line);
+    return name == "ADD" || name == "REMOVE";
+}
+
+string ExecuteWrite(SearchServer& search_server, string_view line) {
+    const string_view name = TakeField(line);
+    if (name == "ADD") {
+        const int document_id = ParseInt(TakeField(line));
+        const DocumentStatus status = ParseStatus(TakeField(line));
+        const vector<int> ratings = ParseRatings(TakeField(line));
+        search_server.AddDocument(document_id, line, status, ratings);
+    }
+    else {
+        search_server.RemoveDocument(ParseInt(TakeField(line)));
+    }
+    return "OK\n";
+}
+
+string ExecuteRead(const SearchServer& search_server, string_view line) {
+    const string_view name = TakeField(line);
+    string answer;
+    if (name == "FIND") {
+        const int max_result_count = ParseInt(TakeField(line));
+        if (max_result_count < 0) {
+            throw invalid_argument("Bad result count");
+        }
+        const vector<Document> documents = search_server.FindTopDocuments(line, DocumentStatus::ACTUAL,
+            static_cast<size_t>(max_result_count));
+        answer = "FOUND " + to_string(documents.size());
+        char relevance[32];
+        for (const Document& document : documents) {
+            snprintf(relevance, sizeof(relevance), "%.6f", document.relevance);
+            answer += ' ' + to_string(document.id) + ' ' + relevance + ' ' + to_string(document.rating);
+        }
+    }
+    else if (name == "MATCH") {
+        const int document_id = ParseInt(TakeField(line));
+        const auto [words, status] = search_server.MatchDocument(line, document_id);
+        answer = "MATCHED "s + string(STATUS_NAMES[static_cast<int>(status)]);
+        for (string_view word : words) {
+            answer.append(" ").append(word);
+        }
+    }
+    else {
+        throw invalid_argument("Unknown command "s + string(name));
+    }
+    answer += '\n';
+    return answer;
+}
+
+template <typename Executor>
+string ExecuteSafely(Executor executor) {
+    try {
+        return executor();
+    }
+    catch (const out_of_range&) {
+        // SearchServer reports unknown document ids this way
+        return "ERROR Unknown document\n";
+    }
+    catch (const exception& e) {
+        return "ERROR "s + e.what() + '\n';
+    }
+}
+
+class Daemon {
+public:
+    Daemon(int listen_fd, SearchServer search_server)
+        : listen_fd_(listen_fd), search_server_(move(search_server)) {
+        epoll_fd_ = epoll_create1(0);
+        if (epoll_fd_ == -1) {
+            ThrowSystemError("epoll_create1");
+        }
+        SetNonBlocking(listen_fd_);
+        Watch(listen_fd_, EPOLLIN, EPOLL_CTL_ADD);
+    }
+
+    void Run() {
+        epoll_event events[MAX_EVENTS];
+        while (true) {
+            // With removed documents piling up, waiting is only allowed once they are dropped
+            const bool needs_compaction = search_server_.GetRemovedDocumentCount() > search_server_.GetDocumentCount();
+            const int event_count = epoll_wait(epoll_fd_, events, MAX_EVENTS, needs_compaction ? 0 : -1);
+            if (event_count == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ThrowSystemError("epoll_wait");
+            }
+            if (event_count == 0) {
+                search_server_.Compact(execution::par);
+                continue;
+            }
+
+            vector<Command> commands;
+            vector<Connection*> touched;
+            for (int i = 0; i < event_count; ++i) {
+                if (events[i].data.fd == listen_fd_) {
+                    AcceptConnections();
+                    continue;
+                }
+                Connection& connection = *connections_.at(events[i].data.fd);
+                if (!connection.is_reading_closed && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                    ReadCommands(connection, commands);
+                }
+                touched.push_back(&connection);
+            }
+
+            ExecuteCommands(commands);
+            for (Command& command : commands) {
+                command.connection->output.push_back(move(command.answer));
+            }
+            for (Connection* connection : touched) {
+                FlushOrClose(*connection);
+            }
+        }
+    }
+
+private:
+    int listen_fd_;
+    int epoll_fd_ = -1;
+    SearchServer search_server_;
+    map<int, unique_ptr<Connection>> connections_;
+
+    void Watch(int fd, uint32_t events, int operation) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, operation, fd, &event) == -1) {
+            ThrowSystemError("epoll_ctl");
+        }
+    }
+
+    void AcceptConnections() {
+        while (true) {
+            const int fd = accept(listen_fd_, nullptr, nullptr);
+            if (fd == -1) {
+                return;
+            }
+            SetNonBlocking(fd);
+            auto connection = make_unique<Connection>();
+            connection->fd = fd;
+            connections_.emplace(fd, move(connection));
+            Watch(fd, EPOLLIN, EPOLL_CTL_ADD);
+        }
+    }
+
+    void ReadCommands(Connection& connection, vector<Command>& commands) {
+        char buffer[READ_CHUNK_SIZE];
+        while (!connection.is_reading_closed) {
+            const ssize_t size = read(connection.fd, buffer, sizeof(buffer));
+            if (size > 0) {
+                connection.input.append(buffer, size);
+                TakeCommands(connection, commands);
+                // A client that never ends its line must not grow the buffer without bound
+                if (connection.input.size() > MAX_LINE_SIZE) {
+                    connection.input.clear();
+                    connection.is_reading_closed = true;
+                }
+            }
+            else if (size == -1 && errno == EINTR) {
+                continue;
+            }
+            else {
+                // End of input or an error, EAGAIN just means everything is read
+                const bool is_end_of_input = size == 0;
+                connection.is_reading_closed = is_end_of_input || errno != EAGAIN;
+                if (is_end_of_input && !connection.input.empty()) {
+                    AddCommand(connection, connection.input, commands);
+                    connection.input.clear();
+                }
+                break;
+            }
+        }
+    }
+
+    // Takes the complete lines off the input
+    static void TakeCommands(Connection& connection, vector<Command>& commands) {
+        size_t line_begin = 0;
+        for (size_t line_end; (line_end = connection.input.find('\n', line_begin)) != string::npos;
+            line_begin = line_end + 1) {
+            AddCommand(connection, string_view(connection.input.data() + line_begin, line_end - line_begin), commands);
+        }
+        connection.input.erase(0, line_begin);
+    }
+
+    static void AddCommand(Connection& connection, string_view line, vector<Command>& commands) {
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        commands.push_back({ &connection, string(line), {} });
+    }
+
+    void ExecuteCommands(vector<Command>& commands) {
+        auto batch_begin = commands.begin();
+        for (auto it = commands.begin(); it != commands.end(); ++it) {
+            if (IsWriteCommand(it->line)) {
+                ExecuteReads(batch_begin, it);
+                it->answer = ExecuteSafely([&] {
+                    return ExecuteWrite(search_server_, it->line);
+                });
+                batch_begin = next(it);
+            }
+        }
+        ExecuteReads(batch_begin, commands.end());
+    }
+
+    void ExecuteReads(vector<Command>::iterator begin, vector<Command>::iterator end) {
+        const SearchServer& search_server = search_server_;
+        for_each(execution::par, begin, end, [&search_server](Command& command) {
+            command.answer = ExecuteSafely([&] {
+                return ExecuteRead(search_server, command.line);
+            });
+        });
+    }
+
+    void FlushOrClose(Connection& connection) {
+        while (!connection.output.empty()) {
+            iovec iovecs[MAX_IOVECS];
+            int iovec_count = 0;
+            for (auto it = connection.output.begin(); it != connection.output.end() && iovec_count < MAX_IOVECS; ++it) {
+                const size_t offset = iovec_count == 0 ? connection.output_offset : 0;
+                iovecs[iovec_count++] = { const_cast<char*>(it->data()) + offset, it->size() - offset };
+            }
+            ssize_t written = writev(connection.fd, iovecs, iovec_count);
+            if (written == -1) {
+                if (errno == EAGAIN) {
+                    break;
+                }
+                if (errno == EINTR) {
+                    continue;
+                }
+                Close(connection);
+                return;
+            }
+            while (written > 0) {
+                const size_t rest = connection.output.front().size() - connection.output_offset;
+                if (static_cast<size_t>(written) < rest) {
+                    connection.output_offset += written;
+                    break;
+                }
+                written -= rest;
+                connection.output.pop_front();
+                connection.output_offset = 0;
+            }
+        }
+
+        if (connection.output.empty() && connection.is_reading_closed) {
+            Close(connection);
+            return;
+        }
+        // Output the socket did not take is written when it becomes writable.
+        // Once the peer has closed its side the fd is no longer watched for
+        // input: end of input is always ready and would wake epoll_wait in a loop.
+        uint32_t watched_events = connection.is_reading_closed ? 0 : static_cast<uint32_t>(EPOLLIN);
+        if (!connection.output.empty()) {
+            watched_events |= EPOLLOUT;
+        }
+        if (watched_events != connection.watched_events) {
+            connection.watched_events = watched_events;
+            Watch(connection.fd, watched_events, EPOLL_CTL_MOD);
+        }
+    }
+
+    void Close(Connection& connection) {
+        const int fd = connection.fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        connections_.erase(fd);
+    }
+};
+
+int Listen(int port, const string& unix_path) {
+    int fd = -1;
+    if (!unix_path.empty()) {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (unix_path.size() >= sizeof(address.sun_path)) {
+            throw invalid_argument("Socket path is too long");
+        }
+        strcpy(address.sun_path, unix_path.c_str());
+        unlink(unix_path.c_str());
+        if (fd == -1 || bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1) {
+            ThrowSystemError("bind " + unix_path);
+        }
+    }
+    else {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        const int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd == -1 || bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1) {
+            ThrowSystemError("bind port " + to_string(port));
+        }
+    }
+    if (listen(fd, SOMAXCONN) == -1) {
+        ThrowSystemError("listen");
+    }
+    return fd;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int port = DEFAULT_PORT;
+    string unix_path;
+    string stop_words;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const string_view option = argv[i];
+        if (option == "--port") {
+            port = ParseInt(argv[i + 1]);
+        }
+        else if (option == "--unix") {
+            unix_path = argv[i + 1];
+        }
+        else if (option == "--stop-words") {
+            stop_words = argv[i + 1];
+        }
+        else {
+            cerr << "Usage: " << argv[0] << " [--port PORT | --unix PATH] [--stop-words WORDS]" << endl;
+            return 1;
+        }
+    }
+
+    // A client going away must not kill the daemon
+    signal(SIGPIPE, SIG_IGN);
+    try {
+        Daemon daemon(Listen(port, unix_path), SearchServer(stop_words));
+        cerr << "Listening on " << (unix_path.empty() ? "127.0.0.1:" + to_string(port) : unix_path) << endl;
+        daemon.Run();
+    }
+    catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+}